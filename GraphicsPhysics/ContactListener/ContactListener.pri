@@ -1,6 +1,7 @@
 INCLUDEPATH += $$PWD
 
 HEADERS += \
+    $$PWD/contactbuffer.h \
     $$PWD/contactlistener.h
 
 SOURCES += \
@@ -0,0 +1,98 @@
+#ifndef CONTACTBUFFER_H
+#define CONTACTBUFFER_H
+
+#include <QVector>
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include "box2d/box2d.h"
+
+/**
+ * @brief The ContactEvent struct   一次接触回调的数据
+ */
+struct ContactEvent
+{
+    enum Type
+    {
+        BeginContact = 0x1,
+        EndContact = 0x2,
+        PreSolve = 0x4,
+        PostSolve = 0x8
+    };
+
+    Type type = BeginContact;
+    b2Body *bodyA = nullptr;    //刚体A,派发前用于确认图元仍存在
+    b2Body *bodyB = nullptr;    //刚体B
+    uintptr_t userDataA = 0;    //刚体A的用户数据(图元指针)
+    uintptr_t userDataB = 0;    //刚体B的用户数据(图元指针)
+    b2Vec2 point {0.0f, 0.0f};  //第一个接触点(世界坐标,米)
+    b2Vec2 normal {0.0f, 0.0f}; //接触法线(世界坐标)
+    float normalImpulse = 0;    //第一个接触点的法向冲量,仅PostSolve
+};
+
+/**
+ * @brief The ContactBuffer class   单生产者单消费者的无锁环形缓冲
+ * 步进中的接触回调写入,步进结束后(多线程模式下在界面线程)一次取出.
+ * 缓冲满时丢弃新的事件,丢弃的数量由dropped()累计.
+ */
+class ContactBuffer
+{
+public:
+    /**
+     * @brief ContactBuffer 构造函数
+     * @param capacity      容量,向上取整为2的幂
+     */
+    explicit ContactBuffer(std::size_t capacity = 16384)
+    {
+        std::size_t size = 1;
+        while(size < capacity)
+        {
+            size <<= 1;
+        }
+        m_events.resize(size);
+        m_mask = size - 1;
+    }
+
+    // 生产者调用
+    bool push(const ContactEvent &event)
+    {
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+        if(head - m_tail.load(std::memory_order_acquire) == m_events.size())
+        {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        m_events[head & m_mask] = event;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 消费者调用,将所有事件追加到events
+    void popAll(QVector<ContactEvent> &events)
+    {
+        std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        const std::size_t head = m_head.load(std::memory_order_acquire);
+        for(; tail != head; ++tail)
+        {
+            events.append(m_events[tail & m_mask]);
+        }
+        m_tail.store(tail, std::memory_order_release);
+    }
+
+    // 缓冲满时丢弃的事件总数
+    std::size_t dropped() const
+    {
+        return m_dropped.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::vector<ContactEvent> m_events;
+    std::size_t m_mask = 0;
+    std::atomic<std::size_t> m_head {0};
+    std::atomic<std::size_t> m_tail {0};
+    std::atomic<std::size_t> m_dropped {0};
+};
+
+#endif // CONTACTBUFFER_H
@@ -2,22 +2,72 @@
 
 ContactListener::ContactListener() {}
 
+void ContactListener::setEnabledTypes(const int &types)
+{
+    m_enabledTypes = types;
+}
+
+int ContactListener::enabledTypes() const
+{
+    return m_enabledTypes;
+}
+
+ContactBuffer &ContactListener::buffer()
+{
+    return m_buffer;
+}
+
 void ContactListener::BeginContact(b2Contact *contact)
 {
-    emit BeginContactSignal(contact);
+    if(m_enabledTypes & ContactEvent::BeginContact)
+    {
+        m_buffer.push(makeEvent(ContactEvent::BeginContact, contact));
+    }
 }
 
 void ContactListener::EndContact(b2Contact *contact)
 {
-    emit EndContactSignal(contact);
+    if(m_enabledTypes & ContactEvent::EndContact)
+    {
+        m_buffer.push(makeEvent(ContactEvent::EndContact, contact));
+    }
 }
 
 void ContactListener::PreSolve(b2Contact *contact, const b2Manifold *oldManifold)
 {
-    emit PreSolveSignal(contact, oldManifold);
+    Q_UNUSED(oldManifold)
+    if(m_enabledTypes & ContactEvent::PreSolve)
+    {
+        m_buffer.push(makeEvent(ContactEvent::PreSolve, contact));
+    }
 }
 
 void ContactListener::PostSolve(b2Contact *contact, const b2ContactImpulse *impulse)
 {
-    emit PostSolveSignal(contact, impulse);
+    if(m_enabledTypes & ContactEvent::PostSolve)
+    {
+        ContactEvent event = makeEvent(ContactEvent::PostSolve, contact);
+        if(impulse->count > 0)
+        {
+            event.normalImpulse = impulse->normalImpulses[0];
+        }
+        m_buffer.push(event);
+    }
+}
+
+ContactEvent ContactListener::makeEvent(const ContactEvent::Type &type, b2Contact *contact) const
+{
+    ContactEvent event;
+    event.type = type;
+    event.bodyA = contact->GetFixtureA()->GetBody();
+    event.bodyB = contact->GetFixtureB()->GetBody();
+    event.userDataA = event.bodyA->GetUserData().pointer;
+    event.userDataB = event.bodyB->GetUserData().pointer;
+
+    // 创建一个b2WorldManifold对象来存储世界坐标的碰撞点
+    b2WorldManifold worldManifold;
+    contact->GetWorldManifold(&worldManifold);
+    event.point = worldManifold.points[0];
+    event.normal = worldManifold.normal;
+    return event;
 }
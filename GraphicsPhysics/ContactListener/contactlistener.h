@@ -1,20 +1,25 @@
 #ifndef CONTACTLISTENER_H
 #define CONTACTLISTENER_H
 
-#include <QObject>
+#include <atomic>
+
 #include "box2d/box2d.h"
+#include "contactbuffer.h"
 
-class ContactListener: public QObject, public b2ContactListener
+/**
+ * @brief The ContactListener class 接触监听
+ * 回调中只把启用类型的事件写入缓冲,由场景在步进结束后批量取出
+ */
+class ContactListener: public b2ContactListener
 {
-    Q_OBJECT
 public:
     ContactListener();
 
-Q_SIGNALS:
-    void BeginContactSignal(b2Contact* contact);
-    void EndContactSignal(b2Contact* contact);
-    void PreSolveSignal(b2Contact* contact, const b2Manifold* oldManifold);
-    void PostSolveSignal(b2Contact* contact, const b2ContactImpulse* impulse);
+    // 设置需要记录的事件类型(ContactEvent::Type的组合),未启用的回调直接返回
+    void setEnabledTypes(const int &types);
+    int enabledTypes() const;
+
+    ContactBuffer &buffer();
 
 protected:
     // 在这里处理接触开始的逻辑
@@ -29,6 +34,12 @@ protected:
     // 在这里处理接触后解决的逻辑
     void PostSolve(b2Contact* contact, const b2ContactImpulse* impulse) override;
 
+private:
+    // 填充两个刚体与接触点
+    ContactEvent makeEvent(const ContactEvent::Type &type, b2Contact *contact) const;
+
+    std::atomic<int> m_enabledTypes {ContactEvent::BeginContact};
+    ContactBuffer m_buffer;
 };
 
 #endif // CONTACTLISTENER_H
@@ -7,13 +7,18 @@ ItemBase::ItemBase(b2World *world, b2BodyDef bd)
 {
     bd.userData.pointer = reinterpret_cast<uintptr_t>(this);
     m_pBody = world->CreateBody(&bd);
+    savePreviousTransform();
     setFlag(QGraphicsItem::ItemIsSelectable, true); // 允许选中
 }
 
 ItemBase::~ItemBase()
 {
-    m_pBody->GetWorld()->DestroyBody(m_pBody);
-    m_pBody = nullptr;
+    // 多线程模式下刚体已交由模拟线程删除
+    if(m_pBody)
+    {
+        m_pBody->GetWorld()->DestroyBody(m_pBody);
+        m_pBody = nullptr;
+    }
     if(m_pB2Shape)
     {
         delete m_pB2Shape;
@@ -23,13 +28,31 @@ ItemBase::~ItemBase()
 
 void ItemBase::setPos(const QPointF &pos)
 {
+    if(PhysicsThread *pThread = physicsThread())
+    {
+        // 由模拟线程修改刚体,下一个快照生效
+        b2Body *body = m_pBody;
+        b2Vec2 position = pointToVec2(pos/Scene::m_pix_meter);
+        pThread->postCommand([body, position](b2World *){ body->SetTransform(position, body->GetAngle()); }, body);
+        return;
+    }
     m_pBody->SetTransform(pointToVec2(pos/Scene::m_pix_meter), m_pBody->GetAngle());
+    // 直接设置的位置不做插值
+    savePreviousTransform();
     updateTransform();
 }
 
 void ItemBase::setRotation(const qreal &angle)
 {
+    if(PhysicsThread *pThread = physicsThread())
+    {
+        b2Body *body = m_pBody;
+        float radians = qDegreesToRadians(angle);
+        pThread->postCommand([body, radians](b2World *){ body->SetTransform(body->GetPosition(), radians); }, body);
+        return;
+    }
     m_pBody->SetTransform(m_pBody->GetPosition(), qDegreesToRadians(angle));
+    savePreviousTransform();
     updateTransform();
 }
 
@@ -65,6 +88,10 @@ void ItemBase::setMaterial(const float &friction, const float &restitution, cons
         pPolygonShape->SetAsBox (this->boundingRect().width()/2.0/Scene::m_pix_meter, this->boundingRect().height()/2.0/Scene::m_pix_meter);
         m_pB2Shape = pPolygonShape;
     }
+    // 形状由图元持有,不能排队到图元可能已被删除之后,多线程模式下等待当前一步完成
+    Scene *pScene = dynamic_cast<Scene *>(scene());
+    QMutexLocker locker(pScene ? pScene->worldMutex() : nullptr);
+
     b2FixtureDef fixtureDef;
     fixtureDef.shape = m_pB2Shape;
     fixtureDef.density = density;
@@ -89,26 +116,90 @@ void ItemBase::setShowShape(const bool &is)
 
 void ItemBase::setLinearVelocity(const QPointF &v)
 {
+    if(PhysicsThread *pThread = physicsThread())
+    {
+        b2Body *body = m_pBody;
+        b2Vec2 velocity = pointToVec2(v / Scene::m_pix_meter);
+        pThread->postCommand([body, velocity](b2World *){ body->SetLinearVelocity(velocity); }, body);
+        return;
+    }
     m_pBody->SetLinearVelocity(pointToVec2(v / Scene::m_pix_meter));
 }
 
 QPointF ItemBase::linearVelocity()
 {
+    if(physicsThread())
+    {
+        return vec2ToPoint(m_linearVelocity) * Scene::m_pix_meter;
+    }
     return vec2ToPoint(m_pBody->GetLinearVelocity()) * Scene::m_pix_meter;
 }
 
-void ItemBase::updateTransform()
+void ItemBase::updateTransform(const float &alpha)
+{
+    applyTransform((1.0f - alpha) * m_previousPosition + alpha * m_pBody->GetPosition(),
+                   (1.0f - alpha) * m_previousAngle + alpha * m_pBody->GetAngle());
+}
+
+void ItemBase::applyTransform(const b2Vec2 &position, const float &bodyAngle)
 {
-    QPointF pos = QPointF(m_pBody->GetPosition().x*Scene::m_pix_meter,m_pBody->GetPosition().y*Scene::m_pix_meter);
-    qreal angle = qRadiansToDegrees(m_pBody->GetAngle());
-    if(pos != QGraphicsItem::pos())
+    QPointF pos = QPointF(position.x*Scene::m_pix_meter,position.y*Scene::m_pix_meter);
+    qreal angle = qRadiansToDegrees(bodyAngle);
+    if(pos == m_pos && angle == m_rotation)
     {
-        QGraphicsItem::setPos(pos);
+        return;
     }
-    if(angle != QGraphicsItem::rotation())
+    m_pos = pos;
+    m_rotation = angle;
+
+    // 位置与旋转合并为一次变换,只触发一次几何变化与重绘
+    QTransform transform;
+    transform.translate(pos.x(), pos.y());
+    transform.rotate(angle);
+    QGraphicsItem::setTransform(transform);
+}
+
+void ItemBase::syncTransform(const float &alpha)
+{
+    if(m_pBody->IsAwake())
     {
-        QGraphicsItem::setRotation(angle);
+        m_isSleepSynced = false;
+        updateTransform(alpha);
     }
+    else if(!m_isSleepSynced)
+    {
+        // 入睡后直接放到最终位置,之后不再更新
+        savePreviousTransform();
+        updateTransform();
+        m_isSleepSynced = true;
+    }
+}
+
+void ItemBase::savePreviousTransform()
+{
+    m_previousPosition = m_pBody->GetPosition();
+    m_previousAngle = m_pBody->GetAngle();
+}
+
+PhysicsThread *ItemBase::physicsThread() const
+{
+    Scene *pScene = dynamic_cast<Scene *>(scene());
+    return pScene ? pScene->physicsThread() : nullptr;
+}
+
+QPointF ItemBase::pos() const
+{
+    return m_pos;
+}
+
+QPointF ItemBase::scenePos() const
+{
+    return mapToScene(QPointF());
+}
+
+qreal ItemBase::rotation() const
+{
+    return m_rotation;
 }
 
 QRectF ItemBase::boundingRect() const
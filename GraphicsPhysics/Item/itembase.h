@@ -6,6 +6,8 @@
 
 #include "box2d/box2d.h"
 
+class PhysicsThread;
+
 class ItemBase: public QGraphicsItem
 {
 
@@ -20,6 +22,17 @@ public:
      * @param angle         角度
      */
     void setRotation(const qreal &angle);
+    /**
+     * 图元由一个变换矩阵同时定位和旋转,QGraphicsItem::pos()/scenePos()/rotation()始终为原点和0.
+     * 下面三个函数隐藏了基类的非虚函数,只在通过ItemBase指针调用时生效;
+     * 通过QGraphicsItem指针取位置时用mapToScene(QPointF())
+     */
+    // 返回位置
+    QPointF pos() const;
+    // 返回场景坐标中的位置
+    QPointF scenePos() const;
+    // 返回旋转量(角度)
+    qreal rotation() const;
     /**
      * @brief setBrush  设置填充
      * @param brush     填充物
@@ -74,7 +87,22 @@ protected:
     ItemBase(b2World *world, b2BodyDef bd);
     ~ItemBase();
 
-    void updateTransform();
+    /**
+     * @brief updateTransform   将刚体位置同步到图元
+     * @param alpha             在上一步位置(0)与当前位置(1)之间的插值系数
+     */
+    void updateTransform(const float &alpha = 1.0f);
+    // 记录当前刚体位置,作为下一次插值的起点
+    void savePreviousTransform();
+    // 将刚体位置(米)与角度(弧度)作为一次变换设置到图元,未变化时跳过
+    void applyTransform(const b2Vec2 &position, const float &angle);
+    /**
+     * @brief syncTransform 每帧同步,睡眠的刚体只在入睡后同步一次
+     * @param alpha         插值系数
+     */
+    void syncTransform(const float &alpha);
+    // 所在场景为多线程模式时返回模拟线程,否则返回空
+    PhysicsThread *physicsThread() const;
 
     inline void setTransformOriginPoint(const QPointF &origin)
     {
@@ -106,6 +134,14 @@ protected:
     QPainterPath m_shape;
     b2Body *m_pBody = nullptr;
     b2Shape *m_pB2Shape = nullptr;
+    b2Vec2 m_previousPosition;  //上一步刚体位置
+    float m_previousAngle = 0;  //上一步刚体角度
+    b2Vec2 m_linearVelocity {0.0f, 0.0f};  //多线程模式下快照中的线速度
+    QPointF m_pos;              //已设置到图元的位置
+    qreal m_rotation = 0;       //已设置到图元的角度
+    bool m_isSleepSynced = false;   //睡眠后是否已同步
+    int m_index = -1;               //在场景图元列表中的位置
+    bool m_isDestroyQueued = false; //是否已排队删除
 
     bool m_isShowShape = false;
     bool m_isShowBoundingRect = false;
@@ -1,6 +1,8 @@
 INCLUDEPATH += $$PWD
 HEADERS += \
+    $$PWD/physicsthread.h \
     $$PWD/scene.h
 
 SOURCES += \
+    $$PWD/physicsthread.cpp \
     $$PWD/scene.cpp
@@ -0,0 +1,216 @@
+#include "physicsthread.h"
+
+PhysicsThread::PhysicsThread(b2World *world, const int &velocityIterations, const int &positionIterations, QObject *parent)
+    :QThread(parent), m_pWorld(world), m_velocityIterations(velocityIterations), m_positionIterations(positionIterations)
+{
+    m_snapshotTimer.start();
+}
+
+PhysicsThread::~PhysicsThread()
+{
+    requestInterruption();
+    wait();
+}
+
+void PhysicsThread::postCommand(const std::function<void (b2World *)> &command, b2Body *body)
+{
+    QMutexLocker locker(&m_commandMutex);
+    Command cmd;
+    cmd.function = command;
+    cmd.body = body;
+    m_commands.append(cmd);
+}
+
+void PhysicsThread::touchBody(b2Body *body)
+{
+    m_touchedBodies.insert(body);
+}
+
+QMutex *PhysicsThread::worldMutex()
+{
+    return &m_worldMutex;
+}
+
+void PhysicsThread::setStepping(const bool &is)
+{
+    m_isStepping = is;
+}
+
+void PhysicsThread::setPhysicsRate(const float &hz)
+{
+    if(hz > 0)
+    {
+        m_physicsHz = hz;
+    }
+}
+
+void PhysicsThread::setMaxSubSteps(const int &steps)
+{
+    m_maxSubSteps = qMax(1, steps);
+}
+
+bool PhysicsThread::takeSnapshot(QVector<BodyState> &states, float &alpha)
+{
+    QMutexLocker locker(&m_snapshotMutex);
+    alpha = qMin(1.0f, float(m_snapshotTimer.nsecsElapsed() / 1e9 * m_physicsHz));
+    if(!m_hasSnapshot)
+    {
+        return false;
+    }
+    states.swap(m_frontStates);
+    m_hasSnapshot = false;
+    return true;
+}
+
+void PhysicsThread::run()
+{
+    QElapsedTimer frameTimer;
+    frameTimer.start();
+    double accumulator = 0.0;
+
+    while(!isInterruptionRequested())
+    {
+        const float step = 1.0f / m_physicsHz;
+        const int maxSubSteps = m_maxSubSteps;
+
+        // 长时间停顿不追赶
+        accumulator += qMin(frameTimer.nsecsElapsed() / 1e9, 0.25);
+        frameTimer.restart();
+        if(!m_isStepping)
+        {
+            accumulator = 0.0;
+        }
+        const int steps = qMin(int(accumulator / step), maxSubSteps);
+
+        bool hasCommands = false;
+        {
+            QMutexLocker locker(&m_commandMutex);
+            hasCommands = !m_commands.isEmpty();
+        }
+
+        if(steps > 0 || hasCommands)
+        {
+            QMutexLocker locker(&m_worldMutex);
+            runCommands();
+            takePendingStates();
+
+            m_backStates.resize(m_pWorld->GetBodyCount());
+            for(int i = 0; i < steps; ++i)
+            {
+                if(i == 0)
+                {
+                    // 记录步进前是否醒着,本次步进中入睡的刚体还要发布一次
+                    int index = 0;
+                    for(b2Body *body = m_pWorld->GetBodyList(); body; body = body->GetNext(), ++index)
+                    {
+                        m_backStates[index].awake = body->IsAwake();
+                    }
+                }
+                if(i == steps - 1)
+                {
+                    // 记录最后一步之前的位置,界面线程在两者之间插值
+                    int index = 0;
+                    for(b2Body *body = m_pWorld->GetBodyList(); body; body = body->GetNext(), ++index)
+                    {
+                        m_backStates[index].previousPosition = body->GetPosition();
+                        m_backStates[index].previousAngle = body->GetAngle();
+                    }
+                }
+                m_pWorld->Step(step, m_velocityIterations, m_positionIterations);
+            }
+
+            // 只发布醒着的、刚入睡的与被修改的刚体,就地压缩;只执行了命令时全部发布
+            int index = 0;
+            int count = 0;
+            for(b2Body *body = m_pWorld->GetBodyList(); body; body = body->GetNext(), ++index)
+            {
+                if(steps > 0 && !m_backStates[index].awake && !body->IsAwake()
+                    && !m_touchedBodies.contains(body))
+                {
+                    // 未被取走的条目保留,界面线程才不会错过入睡前的最终位置
+                    const int pendingAt = m_pendingIndex.value(body, -1);
+                    if(pendingAt >= 0)
+                    {
+                        m_backStates[count++] = m_pendingStates[pendingAt];
+                    }
+                    continue;
+                }
+                BodyState &state = m_backStates[count++];
+                state.previousPosition = m_backStates[index].previousPosition;
+                state.previousAngle = m_backStates[index].previousAngle;
+                state.body = body;
+                state.position = body->GetPosition();
+                state.angle = body->GetAngle();
+                state.linearVelocity = body->GetLinearVelocity();
+                state.awake = body->IsAwake();
+                if(steps == 0)
+                {
+                    state.previousPosition = state.position;
+                    state.previousAngle = state.angle;
+                }
+            }
+            m_backStates.resize(count);
+            m_touchedBodies.clear();
+            m_pendingStates.resize(0);
+            m_pendingIndex.clear();
+            locker.unlock();
+
+            QMutexLocker snapshotLocker(&m_snapshotMutex);
+            m_frontStates.swap(m_backStates);
+            m_hasSnapshot = true;
+            m_snapshotTimer.restart();
+        }
+
+        accumulator -= steps * step;
+        // 达到步数上限时丢弃剩余时间
+        if(steps == maxSubSteps && accumulator >= step)
+        {
+            accumulator = 0.0;
+        }
+
+        // 睡到下一步,留一点余量
+        const double wait = step - accumulator - frameTimer.nsecsElapsed() / 1e9;
+        if(wait > 0.001)
+        {
+            QThread::usleep(static_cast<unsigned long>((wait - 0.0005) * 1e6));
+        }
+    }
+
+    // 退出前执行剩余的命令,避免丢失
+    QMutexLocker locker(&m_worldMutex);
+    runCommands();
+}
+
+void PhysicsThread::runCommands()
+{
+    QVector<Command> commands;
+    {
+        QMutexLocker locker(&m_commandMutex);
+        commands.swap(m_commands);
+    }
+    for(const auto &command: commands)
+    {
+        command.function(m_pWorld);
+        if(command.body)
+        {
+            m_touchedBodies.insert(command.body);
+        }
+    }
+}
+
+void PhysicsThread::takePendingStates()
+{
+    {
+        QMutexLocker locker(&m_snapshotMutex);
+        if(!m_hasSnapshot)
+        {
+            return;
+        }
+        m_pendingStates.swap(m_frontStates);
+        m_hasSnapshot = false;
+    }
+    for(int i = 0; i < m_pendingStates.size(); ++i)
+    {
+        m_pendingIndex.insert(m_pendingStates[i].body, i);
+    }
+}
@@ -0,0 +1,117 @@
+#ifndef PHYSICSTHREAD_H
+#define PHYSICSTHREAD_H
+
+#include <QThread>
+#include <QMutex>
+#include <QVector>
+#include <QHash>
+#include <QSet>
+#include <QElapsedTimer>
+
+#include <atomic>
+#include <functional>
+
+#include "box2d/box2d.h"
+
+/**
+ * @brief The PhysicsThread class   独立的物理模拟线程
+ * 线程运行期间b2World只在本线程中步进,界面线程对刚体的修改以命令的形式排队,
+ * 在下一步之前执行.每次步进后发布刚体的位置快照,界面线程取最新快照更新图元.
+ * 快照只包含本次步进中醒着的刚体与被命令修改过的刚体,一直睡眠的刚体不再发布.
+ * 界面线程还没取走的快照被覆盖时,其中未再次发布的条目(如刚入睡的刚体)并入新快照.
+ */
+class PhysicsThread: public QThread
+{
+    Q_OBJECT
+public:
+    // 一个刚体在快照中的状态
+    struct BodyState
+    {
+        b2Body *body = nullptr;
+        b2Vec2 previousPosition;    //最后一步之前的位置
+        float previousAngle = 0;    //最后一步之前的角度
+        b2Vec2 position;
+        float angle = 0;
+        b2Vec2 linearVelocity;
+        bool awake = false;
+    };
+
+    /**
+     * @brief PhysicsThread         物理线程构造函数
+     * @param world                 要步进的物理世界,由调用者拥有
+     * @param velocityIterations    速度迭代次数
+     * @param positionIterations    位置迭代次数
+     */
+    PhysicsThread(b2World *world, const int &velocityIterations, const int &positionIterations, QObject *parent = nullptr);
+    ~PhysicsThread();
+
+    /**
+     * @brief postCommand   将对物理世界的操作排队,在模拟线程的下一步之前执行
+     * @param command       操作
+     * @param body          操作修改的刚体,即使它在睡眠(或为静态刚体)也会在下一个快照中发布
+     */
+    void postCommand(const std::function<void(b2World *)> &command, b2Body *body = nullptr);
+
+    // 标记刚体在下一个快照中发布,调用时需持有worldMutex()
+    void touchBody(b2Body *body);
+
+    // 需要立即访问物理世界时(如创建刚体)加锁,会等待当前一步完成
+    QMutex *worldMutex();
+
+    // 开始/暂停步进,暂停时仍然执行排队的命令
+    void setStepping(const bool &is);
+
+    void setPhysicsRate(const float &hz);
+    void setMaxSubSteps(const int &steps);
+
+    /**
+     * @brief takeSnapshot  取最新的快照
+     * @param states        有新快照时与其交换
+     * @param alpha         距快照发布经过的时间占一步的比例,用于插值
+     * @return              是否有新快照
+     */
+    bool takeSnapshot(QVector<BodyState> &states, float &alpha);
+
+protected:
+    void run() override;
+
+private:
+    // 排队的操作与其修改的刚体
+    struct Command
+    {
+        std::function<void(b2World *)> function;
+        b2Body *body = nullptr;
+    };
+
+    // 执行排队的命令,调用时已持有m_worldMutex
+    void runCommands();
+
+    // 取回界面线程还没取走的快照,其中的条目要并入下一个快照
+    void takePendingStates();
+
+    b2World *m_pWorld = nullptr;
+    int m_velocityIterations;
+    int m_positionIterations;
+    std::atomic<bool> m_isStepping {false};
+    std::atomic<float> m_physicsHz {120.0f};
+    std::atomic<int> m_maxSubSteps {8};
+
+    QMutex m_worldMutex;
+    QSet<b2Body *> m_touchedBodies;     //下一个快照必须发布的刚体,由m_worldMutex保护
+
+    QMutex m_commandMutex;
+    QVector<Command> m_commands;
+
+    // 仅模拟线程使用
+    QVector<BodyState> m_pendingStates;     //未被取走的快照
+    QHash<b2Body *, int> m_pendingIndex;    //刚体在m_pendingStates中的位置
+
+    // 快照双缓冲: 模拟线程写后台缓冲,加锁后与前台交换
+    QMutex m_snapshotMutex;
+    QVector<BodyState> m_frontStates;
+    QVector<BodyState> m_backStates;
+    bool m_hasSnapshot = false;
+    QElapsedTimer m_snapshotTimer;
+};
+
+#endif // PHYSICSTHREAD_H
@@ -1,16 +1,25 @@
 #include "scene.h"
 #include "maths.h"
 
+#include <QMetaMethod>
+
 int Scene::m_pix_meter = 30;
 
 Scene::Scene(const QVector2D &gravity, const int &pix_meter)
 {
     m_pix_meter = pix_meter;
     m_pWorld = new b2World(vector2DToVec2(gravity));
-    this->startTimer ( 1000 / m_fps);
+    // 大量图元每帧移动,维护BSP索引的开销比查找更大
+    setItemIndexMethod(QGraphicsScene::NoIndex);
+    this->startTimer ( 1000 / m_fps, Qt::PreciseTimer);
     m_pContactListener = new ContactListener;
     m_pWorld->SetContactListener(m_pContactListener);
-    connect(m_pContactListener, SIGNAL(BeginContactSignal(b2Contact*)), this, SLOT(onBeginContact(b2Contact*)));
+}
+
+Scene::~Scene()
+{
+    // 图元析构时会删除刚体,需先停止模拟线程
+    setThreaded(false);
 }
 
 ItemCircle *Scene::CreateCircle(const QPointF &center, const qreal &r, b2BodyDef bd)
@@ -40,27 +49,127 @@ ItemChain *Scene::CreateChan(const QList<QPointF> &points, b2BodyDef bd)
 
 void Scene::DestroyItem(ItemBase *item)
 {
+    // 重复调用只入队一次
+    if(item == nullptr || item->m_isDestroyQueued)
+    {
+        return;
+    }
+    item->m_isDestroyQueued = true;
     m_destroyItems.append(item);
 }
 
 b2Joint *Scene::CreateJoint(const b2JointDef &def)
 {
+    QMutexLocker locker(worldMutex());
     return m_pWorld->CreateJoint(&def);
 }
 
 void Scene::DestroyJoint(b2Joint *joint)
 {
+    if(m_pPhysicsThread)
+    {
+        m_pPhysicsThread->postCommand([joint](b2World *world){ world->DestroyJoint(joint); });
+        return;
+    }
     m_pWorld->DestroyJoint(joint);
 }
 
+void Scene::setPhysicsRate(const float &hz)
+{
+    if(hz > 0)
+    {
+        m_physicsHz = hz;
+    }
+    if(m_pPhysicsThread)
+    {
+        m_pPhysicsThread->setPhysicsRate(hz);
+    }
+}
+
+void Scene::setMaxSubSteps(const int &steps)
+{
+    m_maxSubSteps = qMax(1, steps);
+    if(m_pPhysicsThread)
+    {
+        m_pPhysicsThread->setMaxSubSteps(steps);
+    }
+}
+
+void Scene::setThreaded(const bool &is)
+{
+    if(is == isThreaded())
+    {
+        return;
+    }
+    if(is)
+    {
+        m_pPhysicsThread = new PhysicsThread(m_pWorld, m_velocityIterations, m_positionIterations, this);
+        m_pPhysicsThread->setPhysicsRate(m_physicsHz);
+        m_pPhysicsThread->setMaxSubSteps(m_maxSubSteps);
+        m_pPhysicsThread->setStepping(!m_isStop);
+        m_pPhysicsThread->start();
+    }
+    else
+    {
+        // 等待线程结束,剩余的命令在线程退出前执行
+        delete m_pPhysicsThread;
+        m_pPhysicsThread = nullptr;
+        m_snapshot.clear();
+
+        m_accumulator = 0.0;
+        m_frameTimer.restart();
+        for(ItemBase *item:m_items)
+        {
+            item->savePreviousTransform();
+            item->updateTransform();
+        }
+    }
+}
+
+bool Scene::isThreaded() const
+{
+    return m_pPhysicsThread != nullptr;
+}
+
+PhysicsThread *Scene::physicsThread() const
+{
+    return m_pPhysicsThread;
+}
+
+void Scene::setContactEvents(const int &types)
+{
+    m_pContactListener->setEnabledTypes(types);
+}
+
+std::size_t Scene::droppedContactEvents() const
+{
+    return m_pContactListener->buffer().dropped();
+}
+
+QMutex *Scene::worldMutex() const
+{
+    return m_pPhysicsThread ? m_pPhysicsThread->worldMutex() : nullptr;
+}
+
 void Scene::start()
 {
+    // 暂停期间的时间不计入模拟
+    m_accumulator = 0.0;
+    m_frameTimer.restart();
     m_isStop = false;
+    if(m_pPhysicsThread)
+    {
+        m_pPhysicsThread->setStepping(true);
+    }
 }
 
 void Scene::stop()
 {
     m_isStop = true;
+    if(m_pPhysicsThread)
+    {
+        m_pPhysicsThread->setStepping(false);
+    }
 }
 
 void Scene::setShowAllShape(const bool &is)
@@ -79,47 +188,226 @@ void Scene::setShowAllBoundingRect(const bool &is)
     }
 }
 
-void Scene::onBeginContact(b2Contact* contact)
+bool Scene::isContactAlive(const ContactEvent &event) const
 {
-    auto A = reinterpret_cast<ItemBase*>(contact->GetFixtureA()->GetBody()->GetUserData().pointer);
-    auto B = reinterpret_cast<ItemBase*>(contact->GetFixtureB()->GetBody()->GetUserData().pointer);
+    // 图元删除后刚体可能还在模拟线程中,或其地址已被新刚体复用
+    return m_bodyItems.value(event.bodyA, nullptr) == reinterpret_cast<ItemBase*>(event.userDataA)
+        && m_bodyItems.value(event.bodyB, nullptr) == reinterpret_cast<ItemBase*>(event.userDataB);
+}
+
+void Scene::deliverContacts()
+{
+    // 非多线程模式下每步已取出一部分,这里追加剩余的
+    m_pContactListener->buffer().popAll(m_contactEvents);
+    if(m_contactEvents.isEmpty())
+    {
+        return;
+    }
+
+    for(auto &batch: m_contactBatches)
+    {
+        batch.resize(0);
+    }
+    for(const auto &event: m_contactEvents)
+    {
+        if(!isContactAlive(event))
+        {
+            continue;
+        }
+        switch(event.type)
+        {
+        case ContactEvent::BeginContact: m_contactBatches[0].append(event); break;
+        case ContactEvent::EndContact: m_contactBatches[1].append(event); break;
+        case ContactEvent::PreSolve: m_contactBatches[2].append(event); break;
+        case ContactEvent::PostSolve: m_contactBatches[3].append(event); break;
+        }
+    }
+
+    if(!m_contactBatches[0].isEmpty())
+    {
+        emit contactsBegan(m_contactBatches[0]);
 
-    // 创建一个b2WorldManifold对象来存储世界坐标的碰撞点
-    b2WorldManifold worldManifold;
-    contact->GetWorldManifold(&worldManifold);
-    b2Vec2 worldPoint = worldManifold.points[0];
-    QPointF pos = vec2ToPoint(worldPoint)*m_pix_meter;
-    emit signalBeginContact(A, B, pos);
+        // 逐个接触的信号只在有连接时发送
+        if(isSignalConnected(QMetaMethod::fromSignal(&Scene::signalBeginContact)))
+        {
+            // 按下标遍历,槽函数中调用clear()会清空批次
+            for(int i = 0; i < m_contactBatches[0].size(); ++i)
+            {
+                const ContactEvent &event = m_contactBatches[0].at(i);
+                auto A = reinterpret_cast<ItemBase*>(event.userDataA);
+                auto B = reinterpret_cast<ItemBase*>(event.userDataB);
+                emit signalBeginContact(A, B, vec2ToPoint(event.point)*m_pix_meter);
+            }
+        }
+    }
+    if(!m_contactBatches[1].isEmpty())
+    {
+        emit contactsEnded(m_contactBatches[1]);
+    }
+    if(!m_contactBatches[2].isEmpty())
+    {
+        emit contactsPreSolved(m_contactBatches[2]);
+    }
+    if(!m_contactBatches[3].isEmpty())
+    {
+        emit contactsPostSolved(m_contactBatches[3]);
+    }
+    // resize(0)保留容量,避免每帧重新分配
+    m_contactEvents.resize(0);
 }
 
 void Scene::timerEvent(QTimerEvent *event)
 {
-    auto destroyItems = m_destroyItems;
-    for(auto item: destroyItems)
+    destroyQueuedItems();
+
+    if(m_pPhysicsThread)
     {
-        m_destroyItems.removeOne(item);
-        m_items.removeOne(item);
-        if(this->items().contains(item))
+        // 暂停时也应用快照,排队的修改(如设置位置)才能显示出来
+        applySnapshot();
+        deliverContacts();
+        if(m_isStop)
         {
-            QGraphicsScene::removeItem(item);
-            delete item;
+            return;
         }
+        QGraphicsScene::timerEvent(event);
+        emit signalTimerEvent();
+        return;
     }
 
     if(m_isStop)
     {
         return;
     }
-    m_pWorld->Step(1.0f / m_fps, m_velocityIterations, m_positionIterations);
+
+    // 按真实经过的时间推进模拟,每步固定为 1/m_physicsHz 秒
+    const float step = 1.0f / m_physicsHz;
+    if(!m_frameTimer.isValid())
+    {
+        m_frameTimer.start();
+    }
+    // 窗口被拖动等导致的长时间停顿不追赶
+    m_accumulator += qMin(m_frameTimer.restart() / 1000.0, 0.25);
+
+    int steps = 0;
+    while(m_accumulator >= step && steps < m_maxSubSteps)
+    {
+        for(ItemBase *item:m_items)
+        {
+            // 睡眠的刚体不会移动,上一步位置保持不变
+            if(item->m_pBody->IsAwake())
+            {
+                item->savePreviousTransform();
+            }
+        }
+        m_pWorld->Step(step, m_velocityIterations, m_positionIterations);
+        // 每步取出一次,多个子步的事件不会挤满缓冲
+        m_pContactListener->buffer().popAll(m_contactEvents);
+        m_accumulator -= step;
+        ++steps;
+    }
+    // 达到步数上限时丢弃剩余时间,否则会越积越多
+    if(steps == m_maxSubSteps && m_accumulator >= step)
+    {
+        m_accumulator = 0.0;
+    }
+
+    // 在上一步与当前步之间插值显示
+    const float alpha = m_accumulator / step;
     for(ItemBase *item:m_items)
     {
-        item->updateTransform();
+        item->syncTransform(alpha);
     }
+    deliverContacts();
     QGraphicsScene::timerEvent(event);
     emit signalTimerEvent();
 }
 
+void Scene::applySnapshot()
+{
+    float alpha = 1.0f;
+    m_pPhysicsThread->takeSnapshot(m_snapshot, alpha);
+    for(const auto &state: m_snapshot)
+    {
+        ItemBase *item = m_bodyItems.value(state.body, nullptr);
+        if(item == nullptr)
+        {
+            // 图元已删除
+            continue;
+        }
+        item->m_linearVelocity = state.linearVelocity;
+        // 已入睡的刚体直接放到最终位置
+        const float t = state.awake ? alpha : 1.0f;
+        item->applyTransform((1.0f - t) * state.previousPosition + t * state.position,
+                             (1.0f - t) * state.previousAngle + t * state.angle);
+    }
+}
+
+void Scene::destroyQueuedItems()
+{
+    for(ItemBase *item: m_destroyItems)
+    {
+        removeFromItems(item);
+        m_bodyItems.remove(item->m_pBody);
+        if(m_pPhysicsThread)
+        {
+            // 刚体由模拟线程删除
+            b2Body *body = item->m_pBody;
+            item->m_pBody = nullptr;
+            m_pPhysicsThread->postCommand([body](b2World *world){ world->DestroyBody(body); });
+        }
+        delete item;
+    }
+    m_destroyItems.clear();
+}
+
+void Scene::removeFromItems(ItemBase *item)
+{
+    // 与最后一个交换后删除,不保持顺序
+    const int index = item->m_index;
+    if(index < 0)
+    {
+        return;
+    }
+    ItemBase *last = m_items.last();
+    m_items[index] = last;
+    last->m_index = index;
+    m_items.removeLast();
+    item->m_index = -1;
+}
+
 void Scene::clear()
 {
-    m_destroyItems.append(this->items());
+    const bool isThreaded = m_pPhysicsThread != nullptr;
+    delete m_pPhysicsThread;
+    m_pPhysicsThread = nullptr;
+
+    // 所有刚体随物理世界一起释放,图元不再逐个删除刚体
+    for(ItemBase *item: m_items)
+    {
+        item->m_pBody = nullptr;
+    }
+    const b2Vec2 gravity = m_pWorld->GetGravity();
+    delete m_pWorld;
+    m_pWorld = new b2World(gravity);
+    m_pWorld->SetContactListener(m_pContactListener);
+
+    m_items.clear();
+    m_bodyItems.clear();
+    m_destroyItems.clear();
+    m_snapshot.clear();
+    QGraphicsScene::clear();
+
+    // 丢弃引用已删除图元的接触事件,在接触信号的槽函数中调用时剩余的批次也不再发送
+    m_pContactListener->buffer().popAll(m_contactEvents);
+    m_contactEvents.resize(0);
+    for(auto &batch: m_contactBatches)
+    {
+        batch.resize(0);
+    }
+
+    m_accumulator = 0.0;
+    if(isThreaded)
+    {
+        setThreaded(true);
+    }
 }
@@ -2,9 +2,11 @@
 #define SCENE_H
 
 #include <QGraphicsScene>
+#include <QElapsedTimer>
 #include <QVector2D>
 #include "box2d/box2d.h"
 #include "contactlistener.h"
+#include "physicsthread.h"
 #include "itemcircle.h"
 #include "itemrect.h"
 #include "itempolygon.h"
@@ -21,6 +23,7 @@ public:
      * @param pix_meter 多少像素拟为1米
      */
     Scene(const QVector2D &gravity = QVector2D(0.0f, -9.8f), const int &pix_meter = 30);
+    ~Scene();
 
     /**
      * @brief CreateCircle  创建一个圆形图元
@@ -74,6 +77,47 @@ public:
     // 删除关节
     void DestroyJoint(b2Joint* joint);
 
+    /**
+     * @brief setPhysicsRate    设置物理模拟频率(固定步长),与渲染帧率无关
+     * @param hz                每秒模拟步数,如120或240
+     */
+    void setPhysicsRate(const float &hz);
+
+    /**
+     * @brief setMaxSubSteps    设置每帧最多模拟的步数,防止卡顿后追帧导致越来越慢
+     * @param steps             最大步数
+     */
+    void setMaxSubSteps(const int &steps);
+
+    /**
+     * @brief setThreaded   设置是否在独立线程中模拟
+     * 开启后物理世界由模拟线程步进,图元按模拟线程发布的快照更新,
+     * 对刚体的修改(设置位置/速度、删除图元等)排队到模拟线程执行
+     * @param is            是否
+     */
+    void setThreaded(const bool &is = true);
+    bool isThreaded() const;
+
+    // 多线程模式下返回模拟线程,否则返回空
+    PhysicsThread *physicsThread() const;
+
+    // 多线程模式下直接访问物理世界前需要加的锁,否则为空
+    QMutex *worldMutex() const;
+
+    /**
+     * @brief setContactEvents  设置需要派发的接触事件类型,未启用的类型在回调中直接跳过
+     * @param types             ContactEvent::Type的组合,默认只有BeginContact
+     */
+    void setContactEvents(const int &types);
+
+    /**
+     * @brief droppedContactEvents  因缓冲已满而丢弃的接触事件总数
+     * 非多线程模式下每步取出一次,缓冲只需容纳一步的事件;
+     * 多线程模式下界面线程卡顿时模拟线程可能积累多步,不为0时应减少启用的事件类型
+     * @return                      丢弃的数量
+     */
+    std::size_t droppedContactEvents() const;
+
     static int m_pix_meter; //多少像素为一米
 
 protected:
@@ -81,13 +125,39 @@ protected:
 
     template<typename T, typename... Args>
     T* CreateItem(Args&&... args) {
+        // 图元构造时需要立即创建刚体,多线程模式下等待当前一步完成
+        QMutexLocker locker(worldMutex());
         auto item = new T(m_pWorld, std::forward<Args>(args)...);
+        if(m_pPhysicsThread)
+        {
+            // 新刚体可能不醒(如静态刚体),也要发布一次,以免沿用同地址旧刚体的状态
+            m_pPhysicsThread->touchBody(item->m_pBody);
+        }
+        locker.unlock();
         addItem(item);
+        item->m_index = m_items.size();
         m_items.append(item);
+        m_bodyItems.insert(item->m_pBody, item);
         return item;
     }
 
+    // 将模拟线程的最新快照应用到图元
+    void applySnapshot();
+
+    // 取出步进中记录的接触事件,按类型批量派发
+    void deliverContacts();
+
+    // 事件中的两个图元是否都还存在
+    bool isContactAlive(const ContactEvent &event) const;
+
+    // 删除DestroyItem排队的图元
+    void destroyQueuedItems();
+
+    // O(1)地从m_items中移除
+    void removeFromItems(ItemBase *item);
+
 public Q_SLOTS:
+    // 立即重建物理世界并删除所有图元
     void clear();
     void start();
     void stop();
@@ -99,19 +169,31 @@ Q_SIGNALS:
     void signalTimerEvent();
     void signalBeginContact(ItemBase *A, ItemBase *B, QPointF pos);
 
-protected Q_SLOTS:
-    void onBeginContact(b2Contact* contact);
+    // 每帧一次,事件中的用户数据为图元指针,接触点为世界坐标(米)
+    void contactsBegan(const QVector<ContactEvent> &events);
+    void contactsEnded(const QVector<ContactEvent> &events);
+    void contactsPreSolved(const QVector<ContactEvent> &events);
+    void contactsPostSolved(const QVector<ContactEvent> &events);
 
 private:
     b2World *m_pWorld = nullptr;
     ContactListener *m_pContactListener = nullptr;
     QList<ItemBase *> m_items;
+    QHash<b2Body *, ItemBase *> m_bodyItems;       //刚体对应的图元,用于应用快照
+    PhysicsThread *m_pPhysicsThread = nullptr;
+    QVector<PhysicsThread::BodyState> m_snapshot;   //最近一次取到的快照
+    QVector<ContactEvent> m_contactEvents;          //从缓冲中取出的接触事件
+    QVector<ContactEvent> m_contactBatches[4];      //按类型分组,依次为开始/结束/预解决/后解决
     bool m_isStop = true;
-    float m_fps = 60.0;
+    float m_fps = 60.0;                 //渲染帧率
+    float m_physicsHz = 120.0;          //物理模拟频率
+    int m_maxSubSteps = 8;              //每帧最多模拟步数
+    double m_accumulator = 0.0;         //尚未模拟的时间(秒)
+    QElapsedTimer m_frameTimer;         //两帧之间的真实时间
     int m_velocityIterations = 8; //这是速度迭代次数，用于解算速度约束（例如摩擦力和弹性）。增加迭代次数可以提高模拟的稳定性和准确性，但同样会增加计算量。
     int m_positionIterations = 3; //这是位置迭代次数，用于解算位置约束（例如刚体之间的接触）。增加迭代次数可以减少物体之间的穿透现象，但也会提高计算量。
 
-    QList<QGraphicsItem *> m_destroyItems;
+    QVector<ItemBase *> m_destroyItems; //待删除的图元,不重复
 };
 
 #endif // SCENE_H
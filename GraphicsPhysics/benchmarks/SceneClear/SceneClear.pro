@@ -0,0 +1,6 @@
+TARGET = SceneClear
+
+include($$PWD/../benchmarks.pri)
+
+SOURCES += \
+    $$PWD/sceneclearbenchmark.cpp
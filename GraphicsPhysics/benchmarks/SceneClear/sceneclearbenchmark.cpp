@@ -0,0 +1,46 @@
+#include "benchmarkscene.h"
+
+#include <QtTest/QtTest>
+
+/**
+ * 清空5万个刚体的耗时,多线程模式下包括等待模拟线程退出并重新启动.
+ */
+class SceneClearBenchmark: public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void clear_data();
+
+    void clear();
+};
+
+void SceneClearBenchmark::clear_data()
+{
+    QTest::addColumn<bool>("threaded");
+
+    QTest::newRow("unthreaded") << false;
+    QTest::newRow("threaded") << true;
+}
+
+void SceneClearBenchmark::clear()
+{
+    QFETCH(bool, threaded);
+
+    BenchmarkScene scene;
+    scene.populate(50000);
+    scene.setThreaded(threaded);
+    scene.start();
+    scene.frame();
+
+    // 每次运行只清空一次,用-median多次运行
+    QBENCHMARK_ONCE {
+        scene.clear();
+    }
+
+    QCOMPARE(scene.items().size(), 0);
+}
+
+QTEST_MAIN(SceneClearBenchmark)
+
+#include "sceneclearbenchmark.moc"
@@ -0,0 +1,6 @@
+TARGET = SleepingBodies
+
+include($$PWD/../benchmarks.pri)
+
+SOURCES += \
+    $$PWD/sleepingbodiesbenchmark.cpp
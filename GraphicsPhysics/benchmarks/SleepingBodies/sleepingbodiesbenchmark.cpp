@@ -0,0 +1,50 @@
+#include "benchmarkscene.h"
+
+#include <QtTest/QtTest>
+
+/**
+ * 1万个刚体中大多数睡眠时的帧耗时,睡眠的刚体不应再占用同步与重绘的时间.
+ * "allAwake"一行作为对照,所有刚体每帧都在旋转.
+ */
+class SleepingBodiesBenchmark: public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void frame_data();
+
+    void frame();
+};
+
+void SleepingBodiesBenchmark::frame_data()
+{
+    QTest::addColumn<bool>("threaded");
+    QTest::addColumn<int>("awakeEvery");
+
+    QTest::newRow("mostlySleeping") << false << 100;
+    QTest::newRow("mostlySleeping/threaded") << true << 100;
+    QTest::newRow("allAwake") << false << 1;
+    QTest::newRow("allAwake/threaded") << true << 1;
+}
+
+void SleepingBodiesBenchmark::frame()
+{
+    QFETCH(bool, threaded);
+    QFETCH(int, awakeEvery);
+
+    BenchmarkScene scene;
+    scene.populate(10000, awakeEvery);
+    scene.setThreaded(threaded);
+    scene.start();
+
+    // 第一帧同步所有刚体(包括刚创建的睡眠刚体),不计入
+    scene.frame();
+
+    QBENCHMARK {
+        scene.frame();
+    }
+}
+
+QTEST_MAIN(SleepingBodiesBenchmark)
+
+#include "sleepingbodiesbenchmark.moc"
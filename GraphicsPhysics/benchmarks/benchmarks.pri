@@ -0,0 +1,12 @@
+QT += testlib widgets
+CONFIG += c++14 console testcase
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+include($$PWD/../GraphicsPhysics.pri)
+
+INCLUDEPATH += $$PWD/common
+
+HEADERS += \
+    $$PWD/common/benchmarkscene.h
@@ -0,0 +1,7 @@
+# 物理场景的基准测试,使用Qt Test构建
+# 单独运行其中一个,如`./SleepingBodies -median 5`
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    SleepingBodies \
+    SceneClear
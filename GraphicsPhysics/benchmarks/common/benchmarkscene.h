@@ -0,0 +1,55 @@
+#ifndef BENCHMARKSCENE_H
+#define BENCHMARKSCENE_H
+
+#include <QCoreApplication>
+#include <QTimerEvent>
+#include <QtMath>
+
+#include "scene.h"
+
+/**
+ * 基准测试用的场景,无重力,可以直接驱动一帧
+ */
+class BenchmarkScene: public Scene
+{
+public:
+    BenchmarkScene(): Scene(QVector2D(0.0f, 0.0f))
+    {
+    }
+
+    /**
+     * @brief populate  按网格创建互不接触的圆形刚体
+     * @param count     刚体数量
+     * @param awakeEvery 每隔多少个刚体有一个保持醒着(旋转),0表示全部睡眠
+     */
+    void populate(const int &count, const int &awakeEvery = 0)
+    {
+        const int columns = qCeil(qSqrt(count));
+        for(int i = 0; i < count; ++i)
+        {
+            b2BodyDef bd;
+            bd.type = b2_dynamicBody;
+            if(awakeEvery > 0 && i % awakeEvery == 0)
+            {
+                // 角速度大于睡眠阈值,不会入睡
+                bd.angularVelocity = 1.0f;
+                bd.angularDamping = 0.0f;
+            }
+            else
+            {
+                bd.awake = false;
+            }
+            CreateCircle(QPointF(i % columns * 20.0, i / columns * 20.0), 5.0, bd);
+        }
+    }
+
+    // 执行一帧:同步图元并处理场景的重绘区域
+    void frame()
+    {
+        QTimerEvent event(0);
+        timerEvent(&event);
+        QCoreApplication::processEvents();
+    }
+};
+
+#endif // BENCHMARKSCENE_H
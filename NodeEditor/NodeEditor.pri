@@ -21,10 +21,14 @@ HEADERS += \
     $$PWD/include/QtNodes/internal/ConnectionGraphicsObject.hpp \
     $$PWD/include/QtNodes/internal/ConnectionIdHash.hpp \
     $$PWD/include/QtNodes/internal/ConnectionIdUtils.hpp \
+    $$PWD/include/QtNodes/internal/ConnectionLayer.hpp \
     $$PWD/include/QtNodes/internal/ConnectionState.hpp \
     $$PWD/include/QtNodes/internal/ConnectionStyle.hpp \
+    $$PWD/include/QtNodes/internal/DataFlowExecutor.hpp \
+    $$PWD/include/QtNodes/internal/DataFlowGraphLoader.hpp \
     $$PWD/include/QtNodes/internal/DataFlowGraphModel.hpp \
     $$PWD/include/QtNodes/internal/DataFlowGraphicsScene.hpp \
+    $$PWD/include/QtNodes/internal/DataTypeRegistry.hpp \
     $$PWD/include/QtNodes/internal/DefaultConnectionPainter.hpp \
     $$PWD/include/QtNodes/internal/DefaultHorizontalNodeGeometry.hpp \
     $$PWD/include/QtNodes/internal/DefaultNodePainter.hpp \
@@ -38,12 +42,14 @@ HEADERS += \
     $$PWD/include/QtNodes/internal/NodeDelegateModel.hpp \
     $$PWD/include/QtNodes/internal/NodeDelegateModelRegistry.hpp \
     $$PWD/include/QtNodes/internal/NodeGraphicsObject.hpp \
+    $$PWD/include/QtNodes/internal/NodeRenderInfo.hpp \
     $$PWD/include/QtNodes/internal/NodeState.hpp \
     $$PWD/include/QtNodes/internal/NodeStyle.hpp \
     $$PWD/include/QtNodes/internal/OperatingSystem.hpp \
     $$PWD/include/QtNodes/internal/QStringStdHash.hpp \
     $$PWD/include/QtNodes/internal/QUuidStdHash.hpp \
     $$PWD/include/QtNodes/internal/Serializable.hpp \
+    $$PWD/include/QtNodes/internal/SpatialIndex.hpp \
     $$PWD/include/QtNodes/internal/Style.hpp \
     $$PWD/include/QtNodes/internal/StyleCollection.hpp \
     $$PWD/include/QtNodes/internal/UndoCommands.hpp \
@@ -54,10 +60,14 @@ SOURCES += \
     $$PWD/src/AbstractNodeGeometry.cpp \
     $$PWD/src/BasicGraphicsScene.cpp \
     $$PWD/src/ConnectionGraphicsObject.cpp \
+    $$PWD/src/ConnectionLayer.cpp \
     $$PWD/src/ConnectionState.cpp \
     $$PWD/src/ConnectionStyle.cpp \
+    $$PWD/src/DataFlowExecutor.cpp \
+    $$PWD/src/DataFlowGraphLoader.cpp \
     $$PWD/src/DataFlowGraphModel.cpp \
     $$PWD/src/DataFlowGraphicsScene.cpp \
+    $$PWD/src/DataTypeRegistry.cpp \
     $$PWD/src/DefaultConnectionPainter.cpp \
     $$PWD/src/DefaultHorizontalNodeGeometry.cpp \
     $$PWD/src/DefaultNodePainter.cpp \
@@ -0,0 +1,6 @@
+TARGET = ConnectionIndex
+
+include($$PWD/../benchmarks.pri)
+
+SOURCES += \
+    $$PWD/ConnectionIndexBenchmark.cpp
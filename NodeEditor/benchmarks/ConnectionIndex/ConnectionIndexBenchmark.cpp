@@ -0,0 +1,127 @@
+#include "BenchmarkModels.hpp"
+
+#include <QtNodes/DataFlowGraphicsScene>
+#include <QtNodes/internal/NodeGraphicsObject.hpp>
+
+#include <QtTest/QtTest>
+
+using QtNodes::ConnectionId;
+using QtNodes::DataFlowGraphicsScene;
+using QtNodes::DataFlowGraphModel;
+using QtNodes::NodeGraphicsObject;
+using QtNodes::NodeId;
+using QtNodes::PortIndex;
+using QtNodes::PortType;
+
+/**
+ * Drag latency against graph size. With the per-port and per-node indices
+ * of DataFlowGraphModel both cases should stay flat as the graph grows,
+ * since they only touch the connections of the dragged node.
+ */
+class ConnectionIndexBenchmark : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void dragFrame_data();
+
+    /**
+   * One frame of dragging a node: `dragNodes()` plus the connection queries
+   * the painter makes for each of its ports.
+   */
+    void dragFrame();
+
+    void portConnections_data();
+
+    /// `connections()` for every port of one node.
+    void portConnections();
+
+private:
+    static void addSizes();
+};
+
+void ConnectionIndexBenchmark::addSizes()
+{
+    QTest::addColumn<int>("nodeCount");
+
+    QTest::newRow("1k") << 1000;
+    QTest::newRow("5k") << 5000;
+    QTest::newRow("20k") << 20000;
+}
+
+void ConnectionIndexBenchmark::dragFrame_data()
+{
+    addSizes();
+}
+
+void ConnectionIndexBenchmark::dragFrame()
+{
+    QFETCH(int, nodeCount);
+
+    DataFlowGraphModel model(QtNodes::Benchmarks::registerModels());
+
+    std::vector<NodeId> const nodes = QtNodes::Benchmarks::buildGraph(model, nodeCount);
+
+    DataFlowGraphicsScene scene(model);
+
+    NodeId const nodeId = nodes[nodes.size() / 2];
+
+    NodeGraphicsObject *ngo = scene.nodeGraphicsObject(nodeId);
+    QVERIFY(ngo);
+
+    ngo->setSelected(true);
+
+    scene.beginNodeDrag();
+
+    std::size_t found = 0;
+
+    QBENCHMARK {
+        scene.dragNodes(QPointF(1.0, 0.0));
+
+        for (PortType const portType : {PortType::In, PortType::Out}) {
+            unsigned int const n = model.portCount(nodeId, portType);
+
+            for (PortIndex portIndex = 0; portIndex < n; ++portIndex) {
+                found += model.connections(nodeId, portType, portIndex).size();
+            }
+        }
+    }
+
+    scene.endNodeDrag();
+
+    QVERIFY(found > 0);
+}
+
+void ConnectionIndexBenchmark::portConnections_data()
+{
+    addSizes();
+}
+
+void ConnectionIndexBenchmark::portConnections()
+{
+    QFETCH(int, nodeCount);
+
+    DataFlowGraphModel model(QtNodes::Benchmarks::registerModels());
+
+    std::vector<NodeId> const nodes = QtNodes::Benchmarks::buildGraph(model, nodeCount);
+
+    NodeId const nodeId = nodes[nodes.size() / 2];
+
+    std::size_t found = 0;
+
+    QBENCHMARK {
+        found += model.allConnectionIds(nodeId).size();
+
+        for (PortIndex portIndex = 0; portIndex < 2; ++portIndex) {
+            found += model.connections(nodeId, PortType::In, portIndex).size();
+        }
+
+        found += model.connections(nodeId, PortType::Out, 0).size();
+    }
+
+    QVERIFY(found > 0);
+}
+
+QTEST_MAIN(ConnectionIndexBenchmark)
+
+#include "ConnectionIndexBenchmark.moc"
@@ -0,0 +1,6 @@
+TARGET = NodeGeometry
+
+include($$PWD/../benchmarks.pri)
+
+SOURCES += \
+    $$PWD/NodeGeometryBenchmark.cpp
@@ -0,0 +1,109 @@
+#include "BenchmarkModels.hpp"
+
+#include <QtNodes/DataFlowGraphicsScene>
+#include <QtNodes/internal/AbstractNodeGeometry.hpp>
+#include <QtNodes/internal/NodeGraphicsObject.hpp>
+
+#include <QtTest/QtTest>
+
+using QtNodes::AbstractNodeGeometry;
+using QtNodes::DataFlowGraphicsScene;
+using QtNodes::DataFlowGraphModel;
+using QtNodes::NodeGraphicsObject;
+using QtNodes::NodeId;
+using QtNodes::NodeRole;
+using QtNodes::PortIndex;
+using QtNodes::PortType;
+
+/**
+ * Geometry queries of the default node geometries, horizontal and vertical.
+ * `portQueries` asks for every port position and label position as the
+ * painter does, `moveNodes` shifts every node by one pixel, which moves the
+ * attached connections to the new port positions.
+ */
+class NodeGeometryBenchmark : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void portQueries_data() { addOrientations(); }
+
+    void portQueries();
+
+    void moveNodes_data() { addOrientations(); }
+
+    void moveNodes();
+
+private:
+    static void addOrientations();
+};
+
+void NodeGeometryBenchmark::addOrientations()
+{
+    QTest::addColumn<Qt::Orientation>("orientation");
+
+    QTest::newRow("horizontal") << Qt::Horizontal;
+    QTest::newRow("vertical") << Qt::Vertical;
+}
+
+void NodeGeometryBenchmark::portQueries()
+{
+    QFETCH(Qt::Orientation, orientation);
+
+    DataFlowGraphModel model(QtNodes::Benchmarks::registerModels());
+
+    std::vector<NodeId> const nodes = QtNodes::Benchmarks::buildGraph(model, 2000);
+
+    DataFlowGraphicsScene scene(model);
+    scene.setOrientation(orientation);
+
+    AbstractNodeGeometry &geometry = scene.nodeGeometry();
+
+    QPointF sum;
+
+    QBENCHMARK {
+        for (NodeId const nodeId : nodes) {
+            sum += geometry.captionPosition(nodeId);
+
+            for (PortType const portType : {PortType::In, PortType::Out}) {
+                NodeRole const role = (portType == PortType::In) ? NodeRole::InPortCount
+                                                                 : NodeRole::OutPortCount;
+
+                unsigned int const nPorts = model.nodeData<unsigned int>(nodeId, role);
+
+                for (PortIndex portIndex = 0; portIndex < nPorts; ++portIndex) {
+                    sum += geometry.portPosition(nodeId, portType, portIndex);
+                    sum += geometry.portTextPosition(nodeId, portType, portIndex);
+                }
+            }
+        }
+    }
+
+    QVERIFY(!sum.isNull());
+}
+
+void NodeGeometryBenchmark::moveNodes()
+{
+    QFETCH(Qt::Orientation, orientation);
+
+    DataFlowGraphModel model(QtNodes::Benchmarks::registerModels());
+
+    std::vector<NodeId> const nodes = QtNodes::Benchmarks::buildGraph(model, 2000);
+
+    DataFlowGraphicsScene scene(model);
+    scene.setOrientation(orientation);
+
+    qreal dx = 1.0;
+
+    QBENCHMARK {
+        for (NodeId const nodeId : nodes) {
+            scene.nodeGraphicsObject(nodeId)->moveBy(dx, 0.0);
+        }
+
+        dx = -dx;
+    }
+}
+
+QTEST_MAIN(NodeGeometryBenchmark)
+
+#include "NodeGeometryBenchmark.moc"
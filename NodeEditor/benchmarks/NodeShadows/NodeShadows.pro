@@ -0,0 +1,6 @@
+TARGET = NodeShadows
+
+include($$PWD/../benchmarks.pri)
+
+SOURCES += \
+    $$PWD/NodeShadowsBenchmark.cpp
@@ -0,0 +1,94 @@
+#include "BenchmarkModels.hpp"
+
+#include <QtNodes/DataFlowGraphicsScene>
+#include <QtNodes/StyleCollection>
+#include <QtNodes/internal/NodeGraphicsObject.hpp>
+
+#include <QtGui/QImage>
+#include <QtGui/QPainter>
+#include <QtWidgets/QGraphicsDropShadowEffect>
+
+#include <QtTest/QtTest>
+
+using QtNodes::DataFlowGraphicsScene;
+using QtNodes::DataFlowGraphModel;
+using QtNodes::NodeGraphicsObject;
+using QtNodes::NodeId;
+using QtNodes::StyleCollection;
+
+/**
+ * Frame time while panning across a graph, with the shadows drawn from the
+ * shared nine-patch pixmap and with the QGraphicsDropShadowEffect per node
+ * the nodes used to install. The reciprocal of the reported time is the pan
+ * FPS of the raster paint engine.
+ *
+ * The effect row still draws the nine-patch shadows underneath, so it
+ * overstates the old cost by one blit per node.
+ */
+class NodeShadowsBenchmark : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void pan_data();
+
+    void pan();
+};
+
+void NodeShadowsBenchmark::pan_data()
+{
+    QTest::addColumn<bool>("dropShadowEffect");
+
+    QTest::newRow("ninePatch") << false;
+    QTest::newRow("dropShadowEffect") << true;
+}
+
+void NodeShadowsBenchmark::pan()
+{
+    QFETCH(bool, dropShadowEffect);
+
+    DataFlowGraphModel model(QtNodes::Benchmarks::registerModels());
+
+    std::vector<NodeId> const nodes = QtNodes::Benchmarks::buildGraph(model, 2000);
+
+    DataFlowGraphicsScene scene(model);
+
+    if (dropShadowEffect) {
+        QColor const color = StyleCollection::nodeStyle().ShadowColor;
+
+        for (NodeId const nodeId : nodes) {
+            NodeGraphicsObject *ngo = scene.nodeGraphicsObject(nodeId);
+
+            auto effect = new QGraphicsDropShadowEffect;
+            effect->setOffset(4, 4);
+            effect->setBlurRadius(20);
+            effect->setColor(color);
+
+            ngo->setGraphicsEffect(effect);
+        }
+    }
+
+    QImage frame(1280, 800, QImage::Format_ARGB32_Premultiplied);
+
+    QRectF const bounds = scene.itemsBoundingRect();
+
+    qreal x = bounds.left();
+
+    QBENCHMARK {
+        frame.fill(Qt::transparent);
+
+        QPainter painter(&frame);
+        painter.setRenderHint(QPainter::Antialiasing);
+
+        scene.render(&painter, frame.rect(), QRectF(x, bounds.top(), frame.width(), frame.height()));
+
+        // Pans 16 pixels per frame, wrapping around at the right edge.
+        x += 16.0;
+        if (x + frame.width() > bounds.right())
+            x = bounds.left();
+    }
+}
+
+QTEST_MAIN(NodeShadowsBenchmark)
+
+#include "NodeShadowsBenchmark.moc"
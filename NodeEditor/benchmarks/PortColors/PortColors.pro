@@ -0,0 +1,6 @@
+TARGET = PortColors
+
+include($$PWD/../benchmarks.pri)
+
+SOURCES += \
+    $$PWD/PortColorsBenchmark.cpp
@@ -0,0 +1,129 @@
+#include "BenchmarkModels.hpp"
+
+#include <QtNodes/ConnectionStyle>
+#include <QtNodes/DataFlowGraphicsScene>
+#include <QtNodes/DataTypeRegistry>
+#include <QtNodes/StyleCollection>
+
+#include <QtGui/QImage>
+#include <QtGui/QPainter>
+
+#include <QtTest/QtTest>
+
+using QtNodes::ConnectionStyle;
+using QtNodes::DataFlowGraphicsScene;
+using QtNodes::DataFlowGraphModel;
+using QtNodes::DataTypeHandle;
+using QtNodes::DataTypeRegistry;
+using QtNodes::StyleCollection;
+
+/**
+ * Cost of the per-port connection colors. `frame` paints a whole graph with
+ * about 10k ports at full detail, with the style color and with
+ * data-defined colors. `colorLookup` compares the QString overload of
+ * ConnectionStyle::normalColor(), which interns the id, with the handle
+ * overload the painters use.
+ */
+class PortColorsBenchmark : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void cleanup();
+
+    void frame_data();
+
+    void frame();
+
+    void colorLookup_data();
+
+    void colorLookup();
+
+private:
+    static void setDataDefinedColors(bool enabled);
+};
+
+void PortColorsBenchmark::cleanup()
+{
+    setDataDefinedColors(false);
+}
+
+void PortColorsBenchmark::frame_data()
+{
+    QTest::addColumn<bool>("dataDefinedColors");
+
+    QTest::newRow("styleColor") << false;
+    QTest::newRow("dataDefinedColors") << true;
+}
+
+void PortColorsBenchmark::frame()
+{
+    QFETCH(bool, dataDefinedColors);
+
+    setDataDefinedColors(dataDefinedColors);
+
+    DataFlowGraphModel model(QtNodes::Benchmarks::registerModels());
+
+    // Three ports per node.
+    QtNodes::Benchmarks::buildGraph(model, 3400);
+
+    DataFlowGraphicsScene scene(model);
+
+    // Ports are only painted at full detail, whatever the scale.
+    scene.setLevelOfDetailScales(0.0, 0.0);
+
+    QImage frame(1920, 1200, QImage::Format_ARGB32_Premultiplied);
+
+    QRectF const bounds = scene.itemsBoundingRect();
+
+    QBENCHMARK {
+        frame.fill(Qt::transparent);
+
+        QPainter painter(&frame);
+        painter.setRenderHint(QPainter::Antialiasing);
+
+        scene.render(&painter, frame.rect(), bounds);
+    }
+}
+
+void PortColorsBenchmark::colorLookup_data()
+{
+    QTest::addColumn<bool>("byHandle");
+
+    QTest::newRow("typeId") << false;
+    QTest::newRow("handle") << true;
+}
+
+void PortColorsBenchmark::colorLookup()
+{
+    QFETCH(bool, byHandle);
+
+    ConnectionStyle const &connectionStyle = StyleCollection::connectionStyle();
+
+    QString const typeId = QtNodes::Benchmarks::NumberData().type().id;
+
+    DataTypeHandle const handle = DataTypeRegistry::instance().intern(typeId);
+
+    QColor color;
+
+    // One lookup per port of the graph painted by `frame`.
+    QBENCHMARK {
+        for (int i = 0; i < 10200; ++i) {
+            color = byHandle ? connectionStyle.normalColor(handle)
+                             : connectionStyle.normalColor(typeId);
+        }
+    }
+
+    QVERIFY(color.isValid());
+}
+
+void PortColorsBenchmark::setDataDefinedColors(bool enabled)
+{
+    ConnectionStyle::setConnectionStyle(
+        enabled ? QStringLiteral(R"({"ConnectionStyle": {"UseDataDefinedColors": true}})")
+                : QStringLiteral(R"({"ConnectionStyle": {"UseDataDefinedColors": false}})"));
+}
+
+QTEST_MAIN(PortColorsBenchmark)
+
+#include "PortColorsBenchmark.moc"
@@ -0,0 +1,6 @@
+TARGET = Serialization
+
+include($$PWD/../benchmarks.pri)
+
+SOURCES += \
+    $$PWD/SerializationBenchmark.cpp
@@ -0,0 +1,175 @@
+#include "BenchmarkModels.hpp"
+
+#include <QtCore/QBuffer>
+#include <QtCore/QDataStream>
+#include <QtCore/QDebug>
+#include <QtCore/QJsonDocument>
+
+#include <QtTest/QtTest>
+
+using QtNodes::DataFlowGraphModel;
+
+/**
+ * Save and load times of the JSON and the binary graph formats. Both
+ * directions go through the same steps as DataFlowGraphicsScene::save()
+ * and load(), minus the file and the scene: JSON is built with
+ * `save()` / `QJsonDocument::toJson()` and read with `fromJson()` /
+ * `load()`, the binary format with `saveBinary()` / `loadBinary()`.
+ */
+class SerializationBenchmark : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void saveJson_data() { addSizes(); }
+
+    void saveJson();
+
+    void saveBinary_data() { addSizes(); }
+
+    void saveBinary();
+
+    void loadJson_data() { addSizes(); }
+
+    void loadJson();
+
+    void loadBinary_data() { addSizes(); }
+
+    void loadBinary();
+
+private:
+    static void addSizes();
+
+    static QByteArray jsonFile(int nodeCount);
+
+    static QByteArray binaryFile(int nodeCount);
+};
+
+void SerializationBenchmark::initTestCase()
+{
+    // Reported once, next to the timings.
+    for (int const nodeCount : {1000, 20000}) {
+        qDebug() << nodeCount << "nodes: JSON" << jsonFile(nodeCount).size() << "bytes, binary"
+                 << binaryFile(nodeCount).size() << "bytes";
+    }
+}
+
+void SerializationBenchmark::addSizes()
+{
+    QTest::addColumn<int>("nodeCount");
+
+    QTest::newRow("1k") << 1000;
+    QTest::newRow("5k") << 5000;
+    QTest::newRow("20k") << 20000;
+}
+
+QByteArray SerializationBenchmark::jsonFile(int nodeCount)
+{
+    DataFlowGraphModel model(QtNodes::Benchmarks::registerModels());
+
+    QtNodes::Benchmarks::buildGraph(model, nodeCount);
+
+    return QJsonDocument(model.save()).toJson();
+}
+
+QByteArray SerializationBenchmark::binaryFile(int nodeCount)
+{
+    DataFlowGraphModel model(QtNodes::Benchmarks::registerModels());
+
+    QtNodes::Benchmarks::buildGraph(model, nodeCount);
+
+    QByteArray data;
+
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+
+    QDataStream out(&buffer);
+    model.saveBinary(out);
+
+    return data;
+}
+
+void SerializationBenchmark::saveJson()
+{
+    QFETCH(int, nodeCount);
+
+    DataFlowGraphModel model(QtNodes::Benchmarks::registerModels());
+
+    QtNodes::Benchmarks::buildGraph(model, nodeCount);
+
+    QByteArray data;
+
+    QBENCHMARK {
+        data = QJsonDocument(model.save()).toJson();
+    }
+
+    QVERIFY(!data.isEmpty());
+}
+
+void SerializationBenchmark::saveBinary()
+{
+    QFETCH(int, nodeCount);
+
+    DataFlowGraphModel model(QtNodes::Benchmarks::registerModels());
+
+    QtNodes::Benchmarks::buildGraph(model, nodeCount);
+
+    QByteArray data;
+
+    QBENCHMARK {
+        data.clear();
+
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::WriteOnly);
+
+        QDataStream out(&buffer);
+        model.saveBinary(out);
+    }
+
+    QVERIFY(!data.isEmpty());
+}
+
+void SerializationBenchmark::loadJson()
+{
+    QFETCH(int, nodeCount);
+
+    QByteArray const data = jsonFile(nodeCount);
+
+    std::size_t loaded = 0;
+
+    QBENCHMARK {
+        DataFlowGraphModel model(QtNodes::Benchmarks::registerModels());
+
+        model.load(QJsonDocument::fromJson(data).object());
+
+        loaded = model.allNodeIds().size();
+    }
+
+    QCOMPARE(loaded, static_cast<std::size_t>(nodeCount));
+}
+
+void SerializationBenchmark::loadBinary()
+{
+    QFETCH(int, nodeCount);
+
+    QByteArray const data = binaryFile(nodeCount);
+
+    std::size_t loaded = 0;
+
+    QBENCHMARK {
+        DataFlowGraphModel model(QtNodes::Benchmarks::registerModels());
+
+        QDataStream in(data);
+        model.loadBinary(in);
+
+        loaded = model.allNodeIds().size();
+    }
+
+    QCOMPARE(loaded, static_cast<std::size_t>(nodeCount));
+}
+
+QTEST_MAIN(SerializationBenchmark)
+
+#include "SerializationBenchmark.moc"
@@ -0,0 +1,6 @@
+TARGET = UndoDiff
+
+include($$PWD/../benchmarks.pri)
+
+SOURCES += \
+    $$PWD/UndoDiffBenchmark.cpp
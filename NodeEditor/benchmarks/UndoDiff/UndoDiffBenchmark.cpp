@@ -0,0 +1,76 @@
+#include "BenchmarkModels.hpp"
+
+#include <QtNodes/DataFlowGraphicsScene>
+#include <QtNodes/internal/NodeGraphicsObject.hpp>
+#include <QtNodes/internal/UndoCommands.hpp>
+
+#include <QUndoStack>
+#include <QtCore/QDebug>
+
+#include <QtTest/QtTest>
+
+using QtNodes::DataFlowGraphicsScene;
+using QtNodes::DataFlowGraphModel;
+using QtNodes::DeleteCommand;
+using QtNodes::NodeId;
+
+/**
+ * One delete/undo cycle of a whole selection, as done by the Delete key and
+ * Ctrl+Z. The memory held by the delete command's diff is reported once per
+ * size.
+ */
+class UndoDiffBenchmark : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void deleteUndo_data();
+
+    void deleteUndo();
+};
+
+void UndoDiffBenchmark::deleteUndo_data()
+{
+    QTest::addColumn<int>("nodeCount");
+
+    QTest::newRow("1000") << 1000;
+    QTest::newRow("10000") << 10000;
+}
+
+void UndoDiffBenchmark::deleteUndo()
+{
+    QFETCH(int, nodeCount);
+
+    DataFlowGraphModel model(QtNodes::Benchmarks::registerModels());
+
+    std::vector<NodeId> const nodes = QtNodes::Benchmarks::buildGraph(model, nodeCount);
+
+    DataFlowGraphicsScene scene(model);
+
+    for (NodeId const nodeId : nodes) {
+        scene.nodeGraphicsObject(nodeId)->setSelected(true);
+    }
+
+    QUndoStack &undoStack = scene.undoStack();
+
+    {
+        auto command = new DeleteCommand(&scene);
+
+        qDebug() << nodeCount << "nodes:" << command->diff().memoryCost() << "bytes of undo data";
+
+        undoStack.push(command);
+        undoStack.undo();
+    }
+
+    // Undo selects the restored nodes again, the next cycle deletes the same selection.
+    QBENCHMARK {
+        undoStack.push(new DeleteCommand(&scene));
+        undoStack.undo();
+    }
+
+    QCOMPARE(model.allNodeIds().size(), std::size_t(nodeCount));
+}
+
+QTEST_MAIN(UndoDiffBenchmark)
+
+#include "UndoDiffBenchmark.moc"
@@ -0,0 +1,12 @@
+QT += testlib
+CONFIG += c++14 console testcase
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+include($$PWD/../NodeEditor.pri)
+
+INCLUDEPATH += $$PWD/common
+
+HEADERS += \
+    $$PWD/common/BenchmarkModels.hpp
@@ -0,0 +1,11 @@
+# Benchmarks for the node editor, built with Qt Test.
+# Run a single one with e.g. `./ConnectionIndex -median 5`.
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    ConnectionIndex \
+    Serialization \
+    NodeShadows \
+    UndoDiff \
+    PortColors \
+    NodeGeometry
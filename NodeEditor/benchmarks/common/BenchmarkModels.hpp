@@ -0,0 +1,126 @@
+#pragma once
+
+#include <QtNodes/DataFlowGraphModel>
+#include <QtNodes/NodeData>
+#include <QtNodes/NodeDelegateModel>
+#include <QtNodes/NodeDelegateModelRegistry>
+
+#include <QtCore/QJsonObject>
+#include <QtCore/QPointF>
+
+#include <memory>
+#include <vector>
+
+namespace QtNodes {
+namespace Benchmarks {
+
+class NumberData : public NodeData
+{
+public:
+    explicit NumberData(double value = 0.0)
+        : _value(value)
+    {}
+
+    NodeDataType type() const override { return NodeDataType{"number", "Number"}; }
+
+    double value() const { return _value; }
+
+private:
+    double _value;
+};
+
+/// Two inputs, one output; the output is the sum of the inputs plus a stored offset.
+class SumModel : public NodeDelegateModel
+{
+public:
+    static QString Name() { return QStringLiteral("Sum"); }
+
+    QString caption() const override { return Name(); }
+
+    QString name() const override { return Name(); }
+
+    unsigned int nPorts(PortType portType) const override
+    {
+        return (portType == PortType::In) ? 2 : 1;
+    }
+
+    NodeDataType dataType(PortType, PortIndex) const override { return NumberData().type(); }
+
+    void setInData(std::shared_ptr<NodeData> nodeData, PortIndex const portIndex) override
+    {
+        auto number = std::dynamic_pointer_cast<NumberData>(nodeData);
+
+        _inputs[portIndex] = number ? number->value() : 0.0;
+    }
+
+    std::shared_ptr<NodeData> outData(PortIndex const) override
+    {
+        return std::make_shared<NumberData>(_inputs[0] + _inputs[1] + _offset);
+    }
+
+    QWidget *embeddedWidget() override { return nullptr; }
+
+    QJsonObject save() const override
+    {
+        QJsonObject modelJson = NodeDelegateModel::save();
+
+        modelJson["offset"] = _offset;
+
+        return modelJson;
+    }
+
+    void load(QJsonObject const &p) override { _offset = p["offset"].toDouble(); }
+
+    void saveBinary(QDataStream &out) const override { out << _offset; }
+
+    void loadBinary(QDataStream &in) override { in >> _offset; }
+
+    void setOffset(double offset) { _offset = offset; }
+
+private:
+    double _inputs[2] = {0.0, 0.0};
+
+    double _offset = 0.0;
+};
+
+inline std::shared_ptr<NodeDelegateModelRegistry> registerModels()
+{
+    auto registry = std::make_shared<NodeDelegateModelRegistry>();
+
+    registry->registerModel<SumModel>();
+
+    return registry;
+}
+
+/**
+ * Fills `model` with `nodeCount` SumModel nodes laid out on a grid. Every
+ * node takes its first input from the previous node and its second one from
+ * a pseudo-random earlier node, so there are about two connections per node.
+ */
+inline std::vector<NodeId> buildGraph(DataFlowGraphModel &model, int nodeCount)
+{
+    std::vector<NodeId> nodes;
+    nodes.reserve(nodeCount);
+
+    for (int i = 0; i < nodeCount; ++i) {
+        NodeId const nodeId = model.addNode(SumModel::Name());
+
+        model.setNodeData(nodeId, NodeRole::Position, QPointF((i % 100) * 250.0, (i / 100) * 200.0));
+
+        model.delegateModel<SumModel>(nodeId)->setOffset(i);
+
+        nodes.push_back(nodeId);
+    }
+
+    for (int i = 1; i < nodeCount; ++i) {
+        model.addConnection(ConnectionId{nodes[i - 1], 0, nodes[i], 0});
+
+        if (i > 1)
+            model.addConnection(ConnectionId{nodes[(i * 7919) % (i - 1)], 0, nodes[i], 1});
+    }
+
+    return nodes;
+}
+
+} // namespace Benchmarks
+} // namespace QtNodes
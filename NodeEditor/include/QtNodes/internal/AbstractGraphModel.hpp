@@ -4,16 +4,54 @@
 
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
+#include <QtCore/QByteArray>
 #include <QtCore/QJsonObject>
 #include <QtCore/QObject>
+#include <QtCore/QPointF>
+#include <QtCore/QSize>
 #include <QtCore/QVariant>
 
 #include "ConnectionIdHash.hpp"
 #include "Definitions.hpp"
+#include "NodeData.hpp"
+#include "NodeStyle.hpp"
+
+class QWidget;
 
 namespace QtNodes {
 
+struct NodeRenderInfo;
+
+/**
+ * Net effect of a batch, see AbstractGraphModel::beginBatch(). Only the
+ * objects that still exist when the batch ends are listed among the created,
+ * updated and moved ones.
+ */
+struct GraphChanges
+{
+    std::vector<NodeId> createdNodes;
+
+    std::vector<NodeId> deletedNodes;
+
+    /// Nodes which received `nodeUpdated` and were not created in the batch.
+    std::vector<NodeId> updatedNodes;
+
+    /// Nodes which received `nodePositionUpdated` and were not created in the batch.
+    std::vector<NodeId> movedNodes;
+
+    std::vector<ConnectionId> createdConnections;
+
+    std::vector<ConnectionId> deletedConnections;
+
+    bool empty() const
+    {
+        return createdNodes.empty() && deletedNodes.empty() && updatedNodes.empty()
+               && movedNodes.empty() && createdConnections.empty() && deletedConnections.empty();
+    }
+};
+
 /**
  * The central class in the Model-View approach. It delivers all kinds
  * of information from the backing user data structures that represent
@@ -28,6 +66,8 @@ class NODE_EDITOR_PUBLIC AbstractGraphModel : public QObject
 {
     Q_OBJECT
 public:
+    AbstractGraphModel();
+
     /// Generates a new unique NodeId.
     virtual NodeId newNodeId() = 0;
 
@@ -111,6 +151,63 @@ public:
         return nodeData(nodeId, role).value<T>();
     }
 
+    /// @brief Returns the parsed style of the node.
+    /**
+   * Painters call the function several times per repaint. The default
+   * implementation parses `nodeData(nodeId, NodeRole::Style)` once and
+   * keeps the result until the node is updated or deleted, or until
+   * `invalidateNodeStyle` is called.
+   *
+   * Models that already store a `NodeStyle` per node should override the
+   * function and return their own instance.
+   */
+    virtual NodeStyle const &nodeStyle(NodeId nodeId) const;
+
+    /// @brief Typed shortcuts for the roles used by painters and geometry.
+    /**
+   * The default implementations unwrap the `QVariant` values returned by
+   * `nodeData` and `portData`. Models with their own typed storage should
+   * override them to skip the boxing entirely.
+   */
+    virtual QSize nodeSize(NodeId nodeId) const;
+
+    virtual PortCount portCount(NodeId nodeId, PortType portType) const;
+
+    virtual bool nodeCaptionVisible(NodeId nodeId) const;
+
+    virtual QString nodeCaption(NodeId nodeId) const;
+
+    virtual QWidget *nodeWidget(NodeId nodeId) const;
+
+    virtual NodeDataType portDataType(NodeId nodeId, PortType portType, PortIndex index) const;
+
+    /**
+   * The port's data type id interned in the DataTypeRegistry. Type checks and
+   * color lookups compare these instead of the id strings. The default
+   * implementation interns `portDataType()`; models able to cache the
+   * handles should override it.
+   */
+    virtual DataTypeHandle portDataTypeHandle(NodeId nodeId,
+                                              PortType portType,
+                                              PortIndex index) const;
+
+    virtual bool portCaptionVisible(NodeId nodeId, PortType portType, PortIndex index) const;
+
+    virtual QString portCaption(NodeId nodeId, PortType portType, PortIndex index) const;
+
+    /// Checks whether at least one connection is attached to the port.
+    virtual bool portConnected(NodeId nodeId, PortType portType, PortIndex index) const;
+
+    /// Port caption if it is visible, the data type name otherwise.
+    QString portLabel(NodeId nodeId, PortType portType, PortIndex index) const;
+
+    /**
+   * Fills a typed per-node snapshot used by the node painter. Containers
+   * inside `info` are reused, so keeping one instance around between paint
+   * calls avoids reallocating them.
+   */
+    virtual void fillRenderInfo(NodeId nodeId, NodeRenderInfo &info) const;
+
     virtual NodeFlags nodeFlags(NodeId nodeId) const
     {
         Q_UNUSED(nodeId);
@@ -184,6 +281,19 @@ public:
    */
     virtual void loadNode(QJsonObject const &) {}
 
+    /**
+   * Compact counterpart of `saveNode` kept by the undo commands. The state
+   * does not include the node's id and position, which the commands store
+   * next to it. The default implementation writes `saveNode` as compact
+   * JSON text.
+   */
+    virtual QByteArray saveNodeState(NodeId const nodeId) const;
+
+    /// Restores a node from the output of `saveNodeState`.
+    virtual void loadNodeState(NodeId const nodeId,
+                               QPointF const &position,
+                               QByteArray const &state);
+
 public:
     /**
    * Function clears connections attached to the ports that are scheduled to be
@@ -225,6 +335,22 @@ public:
    */
     void portsInserted();
 
+public:
+    /**
+   * Starts a transaction. The per-item signals are still emitted, so every
+   * listener keeps working, but the model also records them and `endBatch()`
+   * reports their net effect through a single `graphChanged()` signal.
+   * Listeners able to handle the bulk event, like BasicGraphicsScene, skip
+   * the per-item signals while `inBatch()` is `true`.
+   *
+   * Batches nest; only the outermost `endBatch()` emits.
+   */
+    void beginBatch();
+
+    void endBatch();
+
+    bool inBatch() const { return _batchDepth > 0; }
+
 Q_SIGNALS:
     void connectionCreated(ConnectionId const connectionId);
 
@@ -242,8 +368,57 @@ Q_SIGNALS:
 
     void modelReset();
 
+    /// Emitted by the outermost `endBatch()` unless nothing changed.
+    void graphChanged(GraphChanges const &changes);
+
+protected:
+    /// Drops the cached style so the next `nodeStyle()` call re-reads it.
+    void invalidateNodeStyle(NodeId const nodeId) const;
+
+    /**
+   * Adds the node to the `updatedNodes` of the running batch. For changes a
+   * subclass reports through its own signals instead of `nodeUpdated()`.
+   */
+    void recordUpdatedNode(NodeId const nodeId);
+
 private:
     std::vector<ConnectionId> _shiftedByDynamicPortsConnections;
+
+    int _batchDepth;
+
+    /// Signals recorded since the outermost `beginBatch()`.
+    struct BatchRecord
+    {
+        std::unordered_set<NodeId> createdNodes;
+        std::unordered_set<NodeId> deletedNodes;
+        std::unordered_set<NodeId> updatedNodes;
+        std::unordered_set<NodeId> movedNodes;
+        std::unordered_set<ConnectionId> createdConnections;
+        std::unordered_set<ConnectionId> deletedConnections;
+    };
+
+    BatchRecord _batch;
+
+    mutable std::unordered_map<NodeId, NodeStyle> _nodeStyleCache;
+};
+
+/// Keeps a batch open for the lifetime of the object, also when an exception is thrown.
+class ScopedGraphBatch
+{
+public:
+    explicit ScopedGraphBatch(AbstractGraphModel &model)
+        : _model(model)
+    {
+        _model.beginBatch();
+    }
+
+    ~ScopedGraphBatch() { _model.endBatch(); }
+
+    ScopedGraphBatch(ScopedGraphBatch const &) = delete;
+    ScopedGraphBatch &operator=(ScopedGraphBatch const &) = delete;
+
+private:
+    AbstractGraphModel &_model;
 };
 
 } // namespace QtNodes
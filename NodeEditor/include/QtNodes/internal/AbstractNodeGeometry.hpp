@@ -36,6 +36,13 @@ public:
    */
     virtual void recomputeSize(NodeId const nodeId) const = 0;
 
+    /**
+   * Drops whatever the geometry has cached about the node's ports, caption and
+   * widget. The scene calls it when the node is deleted; implementations
+   * caching a layout are expected to drop it in `recomputeSize` as well.
+   */
+    virtual void invalidateLayout(NodeId const nodeId) const { Q_UNUSED(nodeId); }
+
     /// Port position in node's coordinate system.
     virtual QPointF portPosition(NodeId const nodeId,
                                  PortType const portType,
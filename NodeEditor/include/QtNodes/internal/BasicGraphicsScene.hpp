@@ -8,6 +8,7 @@
 #include <memory>
 #include <tuple>
 #include <unordered_map>
+#include <unordered_set>
 
 #include "AbstractGraphModel.hpp"
 #include "AbstractNodeGeometry.hpp"
@@ -16,6 +17,7 @@
 #include "Export.hpp"
 
 #include "QUuidStdHash.hpp"
+#include "SpatialIndex.hpp"
 
 class QUndoStack;
 
@@ -25,6 +27,7 @@ class AbstractConnectionPainter;
 class AbstractGraphModel;
 class AbstractNodePainter;
 class ConnectionGraphicsObject;
+class ConnectionLayer;
 class NodeGraphicsObject;
 class NodeStyle;
 
@@ -58,6 +61,16 @@ public:
 
     QUndoStack &undoStack();
 
+    /**
+   * Caps the memory held by the GraphDiff of the commands on the undo stack.
+   * When the cap is exceeded, the oldest commands are expired: their diffs
+   * are released and QUndoStack drops them instead of undoing them. The
+   * newest command is always kept. Zero, the default, means no limit.
+   */
+    void setUndoMemoryLimit(std::size_t bytes);
+
+    std::size_t undoMemoryLimit() const { return _undoMemoryLimit; }
+
 public:
     /// Creates a "draft" instance of ConnectionGraphicsObject.
     /**
@@ -81,23 +94,134 @@ public:
     /// Deletes all the nodes. Connections are removed automatically.
     void clearScene();
 
+public:
+    /**
+   * Starts an interactive move of the selected nodes. Until `endNodeDrag()`
+   * only the graphics objects move: the model keeps the old positions and
+   * the connections attached to the selection are updated once per
+   * `dragNodes()` call instead of once per moved node. The `QGraphicsScene`
+   * item index is switched off for the duration of the drag.
+   */
+    void beginNodeDrag();
+
+    /// Shifts the dragged nodes by `diff`, given in scene coordinates.
+    void dragNodes(QPointF const &diff);
+
+    /// Records the whole drag as a single MoveNodeCommand, which writes the model positions.
+    void endNodeDrag();
+
+    bool nodeDragActive() const { return _drag.active; }
+
 public:
     /// @returns NodeGraphicsObject associated with the given nodeId.
     /**
+   * With lazy creation the object of a node far from the view is created
+   * right away by this call.
    * @returns nullptr when the object is not found.
    */
     NodeGraphicsObject *nodeGraphicsObject(NodeId nodeId);
 
     /// @returns ConnectionGraphicsObject corresponding to `connectionId`.
     /**
-   * @returns `nullptr` when the object is not found.
+   * @returns `nullptr` when the object is not found or, with lazy creation,
+   * not created yet.
    */
     ConnectionGraphicsObject *connectionGraphicsObject(ConnectionId connectionId);
 
+    /**
+   * @returns the node objects whose scene bounding rects touch `rect`.
+   * Answered from a spatial index kept by the scene itself, which stays valid
+   * while a node drag switches the `QGraphicsScene` index off.
+   */
+    std::vector<NodeGraphicsObject *> nodesIn(QRectF const &rect) const;
+
+    /// @returns the connection objects whose scene bounding rects touch `rect`.
+    std::vector<ConnectionGraphicsObject *> connectionsIn(QRectF const &rect) const;
+
+    /// @returns the topmost node object whose shape contains `scenePoint`.
+    /**
+   * Ties between equal z values go to the node added last, which is the one
+   * drawn on top.
+   */
+    NodeGraphicsObject *nodeAt(QPointF const &scenePoint) const;
+
+    /// Called by the graphics objects whenever their scene bounding rects change.
+    void updateSpatialIndex(NodeGraphicsObject const &ngo);
+
+    void updateSpatialIndex(ConnectionGraphicsObject const &cgo);
+
     Qt::Orientation orientation() const { return _orientation; }
 
     void setOrientation(Qt::Orientation const orientation);
 
+public:
+    /// Defers the creation of graphics objects until they come into view.
+    /**
+   * With lazy creation enabled, a NodeGraphicsObject is only created for the
+   * nodes lying near the area reported by `setVisibleSceneRect()`. Such a
+   * node also gets the objects of all its connections and of the nodes at
+   * their other ends. Everything else stays in the model only, until the view
+   * scrolls close to it or `nodeGraphicsObject()` asks for it.
+   *
+   * Meant for very large graphs; disabled by default. Disabling it creates
+   * all the deferred objects.
+   */
+    void setLazyGraphicsObjectCreation(bool lazy);
+
+    bool lazyGraphicsObjectCreation() const { return _lazyCreation; }
+
+    /// Called by GraphicsView with the part of the scene it is showing.
+    void setVisibleSceneRect(QRectF const &rect);
+
+    /// Number of nodes whose graphics objects are deferred.
+    std::size_t deferredNodeCount() const { return _deferredNodes.size(); }
+
+    /**
+   * Draws the connections through a single ConnectionLayer instead of one
+   * paint call per ConnectionGraphicsObject. Meant for graphs with tens of
+   * thousands of connections; disabled by default.
+   */
+    void setBatchedConnectionRendering(bool batched);
+
+    bool batchedConnectionRendering() const { return _connectionLayer != nullptr; }
+
+    /// @returns `nullptr` unless batched connection rendering is enabled.
+    ConnectionLayer *connectionLayer() const { return _connectionLayer.get(); }
+
+    /**
+   * Keeps the embedded widgets in QGraphicsProxyWidgets only for the nodes
+   * near the visible rect, and only at `LevelOfDetail::Full`. The other nodes
+   * draw a snapshot of their widget taken when it was last embedded.
+   *
+   * Meant for graphs with many embedded widgets; disabled by default.
+   */
+    void setWidgetVirtualization(bool enabled);
+
+    bool widgetVirtualization() const { return _widgetVirtualization; }
+
+    /// Embeds or detaches the node's widget, called when the node is created or moved.
+    void updateWidgetEmbedding(NodeGraphicsObject &ngo);
+
+public:
+    /**
+   * Sets the view scales below which the nodes and connections are drawn with
+   * `LevelOfDetail::Reduced` and `LevelOfDetail::Minimal`. The defaults are
+   * 0.5 and 0.25.
+   */
+    void setLevelOfDetailScales(double reduced, double minimal);
+
+    /// @returns the level of detail the painters use at the given view scale.
+    LevelOfDetail levelOfDetail(double scale) const;
+
+    /// The level of detail for the scale last reported by `setViewScale()`.
+    LevelOfDetail levelOfDetail() const { return _levelOfDetail; }
+
+    /**
+   * Called by GraphicsView with its current scale. Leaving `LevelOfDetail::Full`
+   * hides the embedded widgets, coming back shows them again.
+   */
+    void setViewScale(double scale);
+
 public:
     /// Can @return an instance of the scene context menu in subclass.
     /**
@@ -136,9 +260,42 @@ private:
    */
     void traverseGraphAndPopulateGraphicsObjects();
 
+    /// Expires the oldest undo commands until `undoMemoryLimit()` is respected.
+    void enforceUndoMemoryLimit();
+
     /// Redraws adjacent nodes for given `connectionId`
     void updateAttachedNodes(ConnectionId const connectionId, PortType const portType);
 
+    /// Looks the object up without creating a deferred one.
+    NodeGraphicsObject *existingNodeGraphicsObject(NodeId const nodeId) const;
+
+    /**
+   * Creates the object of a deferred node, if needed, and of its deferred
+   * connections whose other end exists. With `withNeighbours` the nodes at
+   * the other ends are created as well, so that all the connections appear.
+   */
+    NodeGraphicsObject *createNodeGraphicsObject(NodeId const nodeId, bool withNeighbours);
+
+    void createConnectionGraphicsObject(ConnectionId const connectionId);
+
+    /// Scene area around the visible rect in which deferred nodes are created.
+    QRectF lazyCreationArea() const;
+
+    /// Creates the deferred nodes lying in `lazyCreationArea()`.
+    void createVisibleGraphicsObjects();
+
+    /// Re-decides the widget embedding after the view has scrolled or zoomed.
+    void updateEmbeddedWidgets();
+
+    /// Creates the object of a new node, or defers it in the lazy mode.
+    void placeNodeGraphicsObject(NodeId const nodeId);
+
+    /// Creates the object of a new connection unless both its ends are deferred.
+    void placeConnectionGraphicsObject(ConnectionId const connectionId);
+
+    /// @returns `true` if an existing object was moved.
+    bool moveNodeGraphicsObject(NodeId const nodeId);
+
 public Q_SLOTS:
     /// Slot called when the `connectionId` is erased form the AbstractGraphModel.
     void onConnectionDeleted(ConnectionId const connectionId);
@@ -156,6 +313,9 @@ public Q_SLOTS:
 
     void onNodeClicked(NodeId const nodeId);
 
+    /// Applies the net effect of a model batch in a single pass.
+    void onGraphChanged(GraphChanges const &changes);
+
     void onModelReset();
 
 private:
@@ -171,6 +331,32 @@ private:
 
     std::unique_ptr<ConnectionGraphicsObject> _draftConnection;
 
+    std::unique_ptr<ConnectionLayer> _connectionLayer;
+
+    bool _widgetVirtualization;
+
+    /// Nodes whose widgets are embedded while the virtualization is enabled.
+    std::unordered_set<NodeId> _embeddedWidgetNodes;
+
+    bool _lazyCreation;
+
+    QRectF _visibleSceneRect;
+
+    /// Nodes without graphics objects with their last known positions.
+    std::unordered_map<NodeId, QPointF> _deferredNodes;
+
+    /// Positions of the deferred nodes, for `createVisibleGraphicsObjects`.
+    SpatialIndex<NodeId> _deferredNodeIndex;
+
+    SpatialIndex<NodeId> _nodeIndex;
+
+    SpatialIndex<ConnectionId> _connectionIndex;
+
+    /// Nodes created on demand which still have deferred connections.
+    std::unordered_set<NodeId> _partialNodes;
+
+    std::unordered_set<ConnectionId> _deferredConnections;
+
     std::unique_ptr<AbstractNodeGeometry> _nodeGeometry;
 
     std::unique_ptr<AbstractNodePainter> _nodePainter;
@@ -179,9 +365,33 @@ private:
 
     bool _nodeDrag;
 
+    struct NodeDrag
+    {
+        bool active = false;
+
+        std::unordered_set<NodeId> nodes;
+
+        /// Connections attached to the dragged nodes, each listed once.
+        std::vector<ConnectionId> connections;
+
+        QPointF offset;
+    };
+
+    NodeDrag _drag;
+
     QUndoStack *_undoStack;
 
+    std::size_t _undoMemoryLimit;
+
     Qt::Orientation _orientation;
+
+    double _reducedDetailScale;
+
+    double _minimalDetailScale;
+
+    double _viewScale;
+
+    LevelOfDetail _levelOfDetail;
 };
 
 } // namespace QtNodes
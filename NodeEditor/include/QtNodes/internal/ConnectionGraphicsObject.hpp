@@ -3,6 +3,7 @@
 #include <utility>
 
 #include <QtCore/QUuid>
+#include <QtGui/QPainterPath>
 #include <QtWidgets/QGraphicsObject>
 
 #include "ConnectionState.hpp"
@@ -37,8 +38,10 @@ public:
 
     ConnectionId const &connectionId() const;
 
+    /// Cached, recomputed after an end point changes.
     QRectF boundingRect() const override;
 
+    /// Cached hit-test stroke, built on the first hit test after an end point changes.
     QPainterPath shape() const override;
 
     QPointF const &endPoint(PortType portType) const;
@@ -58,6 +61,15 @@ public:
 
     ConnectionState &connectionState();
 
+    /**
+   * A batched connection is drawn by the scene's ConnectionLayer, which also
+   * handles its hover and clicks. The object only paints itself while it is
+   * hovered or selected.
+   */
+    void setBatched(bool batched);
+
+    bool batched() const { return _batched; }
+
 protected:
     void paint(QPainter *painter,
                QStyleOptionGraphicsItem const *option,
@@ -82,6 +94,9 @@ private:
 
     std::pair<QPointF, QPointF> pointsC1C2Vertical() const;
 
+    /// Recomputes the control points and the bounding rect if an end point changed.
+    void updateGeometry() const;
+
 private:
     ConnectionId _connectionId;
 
@@ -91,6 +106,20 @@ private:
 
     mutable QPointF _out;
     mutable QPointF _in;
+
+    // Geometry cache, see `updateGeometry()`.
+
+    mutable bool _geometryDirty;
+
+    mutable bool _shapeDirty;
+
+    mutable std::pair<QPointF, QPointF> _c1c2;
+
+    mutable QRectF _boundingRect;
+
+    mutable QPainterPath _shape;
+
+    bool _batched;
 };
 
 } // namespace QtNodes
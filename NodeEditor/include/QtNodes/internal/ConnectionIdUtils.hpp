@@ -2,6 +2,7 @@
 
 #include "Definitions.hpp"
 
+#include <QDataStream>
 #include <QJsonObject>
 
 #include <iostream>
@@ -148,4 +149,23 @@ inline ConnectionId fromJson(QJsonObject const &connJson)
     return connId;
 }
 
+inline QDataStream &operator<<(QDataStream &out, ConnectionId const &connId)
+{
+    out << static_cast<quint32>(connId.outNodeId) << static_cast<quint32>(connId.outPortIndex)
+        << static_cast<quint32>(connId.inNodeId) << static_cast<quint32>(connId.inPortIndex);
+
+    return out;
+}
+
+inline QDataStream &operator>>(QDataStream &in, ConnectionId &connId)
+{
+    quint32 outNodeId, outPortIndex, inNodeId, inPortIndex;
+
+    in >> outNodeId >> outPortIndex >> inNodeId >> inPortIndex;
+
+    connId = ConnectionId{outNodeId, outPortIndex, inNodeId, inPortIndex};
+
+    return in;
+}
+
 } // namespace QtNodes
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <QtCore/QHash>
+#include <QtCore/QLineF>
+#include <QtCore/QVector>
+#include <QtGui/QColor>
+#include <QtGui/QPainterPath>
+#include <QtGui/QPolygonF>
+#include <QtWidgets/QGraphicsItem>
+
+#include "ConnectionIdHash.hpp"
+#include "Definitions.hpp"
+#include "Export.hpp"
+
+#include <unordered_map>
+
+namespace QtNodes {
+
+class BasicGraphicsScene;
+class ConnectionGraphicsObject;
+
+/**
+ * Draws all the connections of a BasicGraphicsScene in a single item.
+ *
+ * Every connection is flattened once into a polyline, which is cached until
+ * one of its ends moves. A repaint collects the connections overlapping the
+ * exposed rect from the scene's spatial index and draws their segments with
+ * one `drawLines()` call per color.
+ *
+ * The ConnectionGraphicsObjects stay in the scene for selection and keyboard
+ * handling, but stop drawing themselves unless hovered or selected. Hover and
+ * clicks are hit-tested against the cached polylines by this item.
+ *
+ * @see BasicGraphicsScene::setBatchedConnectionRendering
+ */
+class NODE_EDITOR_PUBLIC ConnectionLayer : public QGraphicsItem
+{
+public:
+    // Needed for qgraphicsitem_cast
+    enum { Type = UserType + 3 };
+
+    int type() const override { return Type; }
+
+public:
+    /// Adds itself to the scene below all the other items.
+    ConnectionLayer(BasicGraphicsScene &scene);
+
+    QRectF boundingRect() const override;
+
+    /// Only the cached curves count, the empty space is left to the view.
+    bool contains(QPointF const &point) const override;
+
+    /**
+     * The cached curves stroked to the hit tolerance. Built on first use and
+     * kept until a connection changes.
+     */
+    QPainterPath shape() const override;
+
+    /**
+     * Scene hit tests (`items(pos)`, `itemAt()`, rubber band) go through here
+     * rather than `contains()`. Answered from the spatial index and the
+     * cached curves, without building `shape()`.
+     */
+    bool collidesWithPath(QPainterPath const &path,
+                          Qt::ItemSelectionMode mode = Qt::IntersectsItemShape) const override;
+
+    /// Drops the cached curve, called whenever the connection moves or goes away.
+    void invalidate(ConnectionId const &connectionId);
+
+    void clear();
+
+    /// @returns the connection whose curve passes within `tolerance` of `scenePoint`.
+    ConnectionGraphicsObject *connectionAt(QPointF const &scenePoint, qreal tolerance = 5.0) const;
+
+protected:
+    void paint(QPainter *painter,
+               QStyleOptionGraphicsItem const *option,
+               QWidget *widget = 0) override;
+
+    void hoverEnterEvent(QGraphicsSceneHoverEvent *event) override;
+
+    void hoverMoveEvent(QGraphicsSceneHoverEvent *event) override;
+
+    void hoverLeaveEvent(QGraphicsSceneHoverEvent *event) override;
+
+    void mousePressEvent(QGraphicsSceneMouseEvent *event) override;
+
+private:
+    struct Curve
+    {
+        /// Flattened cubic in scene coordinates.
+        QPolygonF points;
+
+        QColor color;
+    };
+
+    Curve const &curve(ConnectionGraphicsObject const &cgo) const;
+
+    /// Moves the hover highlight, emitting the scene's hover signals.
+    void setHovered(ConnectionGraphicsObject *cgo, QPoint const &screenPos);
+
+private:
+    BasicGraphicsScene &_scene;
+
+    mutable std::unordered_map<ConnectionId, Curve> _curves;
+
+    mutable QPainterPath _shape;
+
+    mutable bool _hasShape;
+
+    /// Segments grouped by color, kept between repaints to reuse the allocations.
+    QHash<QRgb, QVector<QLineF>> _lines;
+
+    bool _hasHovered;
+
+    ConnectionId _hovered;
+};
+
+} // namespace QtNodes
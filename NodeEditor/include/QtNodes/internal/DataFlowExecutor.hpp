@@ -0,0 +1,204 @@
+#pragma once
+
+#include "ConnectionIdHash.hpp"
+#include "Definitions.hpp"
+#include "Export.hpp"
+#include "NodeData.hpp"
+
+#include <QtCore/QObject>
+#include <QtCore/QThreadPool>
+
+#include <deque>
+#include <memory>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace QtNodes {
+
+class DataFlowGraphModel;
+class NodeDelegateModel;
+
+/**
+ * Evaluates a DataFlowGraphModel in waves instead of pushing the data
+ * depth-first on every `dataUpdated` signal.
+ *
+ * A wave starts from the nodes whose inputs were changed and covers
+ * everything downstream of them. Each node of the wave counts its
+ * predecessors that are not evaluated yet and becomes ready as soon as the
+ * counter drops to zero, so independent branches are evaluated at the same
+ * time.
+ *
+ * Nodes returning `true` from NodeDelegateModel::computeInBackground() run
+ * NodeDelegateModel::compute() on the executor's thread pool; the results are
+ * delivered back to the GUI thread through queued calls. All other nodes
+ * receive their inputs on the GUI thread.
+ *
+ * Every node is evaluated at most once per wave: all of its changed inputs
+ * are handed over in a single NodeDelegateModel::setInDataBatch() call, even
+ * if the node is reachable from the changed nodes by several paths.
+ *
+ * The executor is created by DataFlowGraphModel for the `Threaded` and
+ * `Topological` propagation modes; the latter evaluates every node on the
+ * GUI thread.
+ */
+class NODE_EDITOR_PUBLIC DataFlowExecutor : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// Counters accumulated over all the waves since the last `resetStats()`.
+    struct Stats
+    {
+        /// Number of finished waves.
+        quint64 waves = 0;
+
+        /// Nodes actually evaluated.
+        quint64 evaluations = 0;
+
+        /**
+     * Estimated number of `setInData` calls the depth-first propagation
+     * would make for the same updates: one per path from a changed port to
+     * the node.
+     */
+        quint64 depthFirstEvaluations = 0;
+
+        /// Nodes left unevaluated because they are part of a cycle.
+        quint64 cycleSkips = 0;
+
+        quint64 savedEvaluations() const
+        {
+            return depthFirstEvaluations > evaluations ? depthFirstEvaluations - evaluations : 0;
+        }
+    };
+
+public:
+    DataFlowExecutor(DataFlowGraphModel &model);
+
+    /// Waits for the running background computations.
+    ~DataFlowExecutor() override;
+
+    QThreadPool &threadPool() { return _threadPool; }
+
+    /// `true` between `waveStarted()` and `waveFinished()`.
+    bool isRunning() const { return _waveActive; }
+
+    /**
+   * When disabled, the nodes opting in for NodeDelegateModel::compute() are
+   * evaluated on the GUI thread like all the others. Enabled by default.
+   */
+    void setThreaded(bool threaded) { _threaded = threaded; }
+
+    bool threaded() const { return _threaded; }
+
+    Stats const &stats() const { return _stats; }
+
+    void resetStats() { _stats = Stats(); }
+
+    /**
+   * Runs the current wave, and the one queued after it, to completion: waits
+   * for the background computations and delivers their results right away,
+   * so every running node gets its `setComputedData` and `computingFinished`.
+   * Called before the executor is destroyed while the graph stays in use.
+   * Does nothing when called from inside an evaluation.
+   */
+    void finish();
+
+public:
+    /// Schedules the nodes connected to the output port for evaluation.
+    void outPortDataUpdated(NodeId const nodeId, PortIndex const portIndex);
+
+    /// Schedules the node because the data arriving at its input port changed.
+    void inPortDataChanged(NodeId const nodeId, PortIndex const portIndex);
+
+    /// Must be called after the connection is removed from the model.
+    void connectionDeleted(ConnectionId const connectionId);
+
+    /**
+   * Must be called when the node is removed from the model, with the node's
+   * delegate model. The delegate is destroyed right away, unless its
+   * `compute()` is still running on the thread pool: then it is kept until
+   * the task reports back, and its result is dropped.
+   */
+    void nodeDeleted(NodeId const nodeId, std::unique_ptr<NodeDelegateModel> delegate);
+
+Q_SIGNALS:
+    void waveStarted();
+
+    void waveFinished();
+
+private:
+    void startWave();
+
+    void processReadyNodes();
+
+    void evaluate(NodeId const nodeId);
+
+    /// `dirtyPorts` are the input ports whose data changed, reported once the node is computed.
+    void dispatch(NodeId const nodeId,
+                  std::vector<std::shared_ptr<NodeData>> inputs,
+                  std::set<PortIndex> dirtyPorts);
+
+    void onNodeComputed(NodeId const nodeId,
+                        NodeDelegateModel const *computed,
+                        std::set<PortIndex> const &dirtyPorts,
+                        std::vector<std::shared_ptr<NodeData>> const &inputs,
+                        std::vector<std::shared_ptr<NodeData>> const &outputs);
+
+    /// Propagates the `changedPorts` downstream and releases the successors.
+    void finishNode(NodeId const nodeId, std::set<PortIndex> const &changedPorts);
+
+    void finishWaveIfIdle();
+
+    std::shared_ptr<NodeData> inputData(NodeId const nodeId, PortIndex const portIndex) const;
+
+private:
+    DataFlowGraphModel &_model;
+
+    QThreadPool _threadPool;
+
+    bool _threaded;
+
+    Stats _stats;
+
+    /// Input ports changed outside of the running wave.
+    std::unordered_map<NodeId, std::set<PortIndex>> _dirtyPorts;
+
+    bool _waveActive;
+
+    bool _processing;
+
+    /// Node whose `setInDataBatch` or `setComputedData` is being called right now.
+    NodeId _evaluatingNode;
+
+    /// Output ports reported by `_evaluatingNode` through `dataUpdated`.
+    std::set<PortIndex> _emittedPorts;
+
+    // State of the running wave.
+
+    std::unordered_map<NodeId, std::set<PortIndex>> _waveDirtyPorts;
+
+    std::unordered_set<NodeId> _unfinished;
+
+    std::unordered_map<NodeId, unsigned int> _pendingPredecessors;
+
+    /**
+   * Connections counted in `_pendingPredecessors` when the wave started.
+   * Only these release their target, connections created or deleted during
+   * the wave leave the counters alone.
+   */
+    std::unordered_set<ConnectionId> _countedConnections;
+
+    /// Number of paths from the changed ports to the node, for `Stats`.
+    std::unordered_map<NodeId, quint64> _pathCounts;
+
+    std::deque<NodeId> _ready;
+
+    std::unordered_set<NodeId> _running;
+
+    /// Delegates of deleted nodes still read by a running `compute()`.
+    std::unordered_map<NodeDelegateModel const *, std::unique_ptr<NodeDelegateModel>> _detached;
+};
+
+} // namespace QtNodes
@@ -0,0 +1,142 @@
+#pragma once
+
+#include "Definitions.hpp"
+#include "DataFlowGraphModel.hpp"
+#include "Export.hpp"
+
+#include <QtCore/QJsonObject>
+#include <QtCore/QObject>
+#include <QtCore/QString>
+#include <QtCore/QTimer>
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace QtNodes {
+
+/**
+ * Loads a saved graph into a DataFlowGraphModel without blocking the GUI.
+ *
+ * The file is read and parsed on a worker thread, which splits it into
+ * batches of nodes and connections. The batches are inserted into the model
+ * from the event loop, a few at a time, so that a single event loop iteration
+ * never spends more than `timeSlice()` milliseconds on the graph. Both the
+ * JSON and the binary formats are recognized.
+ *
+ * The model must be empty, or at least free of the ids stored in the file,
+ * when the loading starts.
+ */
+class NODE_EDITOR_PUBLIC DataFlowGraphLoader : public QObject
+{
+    Q_OBJECT
+
+public:
+    DataFlowGraphLoader(DataFlowGraphModel &model, QObject *parent = nullptr);
+
+    /// Cancels the running loading and joins the worker.
+    ~DataFlowGraphLoader() override;
+
+    /// Milliseconds spent inserting batches per event loop iteration, 8 by default.
+    void setTimeSlice(int milliseconds) { _timeSlice = milliseconds; }
+
+    int timeSlice() const { return _timeSlice; }
+
+    bool isRunning() const { return _running; }
+
+public:
+    /**
+   * Starts loading the file. The worker of a previous, cancelled loading
+   * is joined first.
+   * @returns `false` when the file is not readable or a loading is running already.
+   */
+    bool start(QString const &fileName);
+
+    /**
+   * Drops the batches not inserted yet and returns right away. The worker
+   * notices the cancellation between two chunks of the file and exits; it
+   * is joined by the next `start()` or by the destructor.
+   */
+    void cancel();
+
+Q_SIGNALS:
+    /// Emitted after every time slice with the totals inserted so far.
+    void progress(unsigned int loadedNodes, unsigned int loadedConnections);
+
+    /// `success` is `false` for unreadable files and unknown node models.
+    void finished(bool success);
+
+private:
+    struct Batch
+    {
+        std::vector<QJsonObject> nodes;
+
+        std::vector<ConnectionId> connections;
+
+        /// Used by the binary format instead of the two vectors above.
+        DataFlowGraphModel::BinaryChunk chunk;
+    };
+
+    /// State shared with the worker, which may outlive a `cancel()` until joined.
+    struct Job
+    {
+        std::atomic<bool> cancelled{false};
+
+        std::mutex mutex;
+
+        // Guarded by `mutex`.
+
+        std::deque<Batch> batches;
+
+        bool parsingDone = false;
+
+        bool parsingSucceeded = false;
+
+        /// Started by the worker when there is something to insert, reset by `cancel()`.
+        QTimer *timer = nullptr;
+    };
+
+    /// Worker thread body.
+    static void parse(std::shared_ptr<Job> job, QString const fileName);
+
+    /// Reads the whole device, checking for a cancellation between chunks.
+    static bool readAll(Job &job, QIODevice &device, QByteArray &data);
+
+    static void parseJson(Job &job, QByteArray const &data);
+
+    static void parseBinary(Job &job, QDataStream &in);
+
+    /// Called by the worker, hands the batch over to the GUI thread.
+    static void push(Job &job, Batch batch);
+
+    static void finishParsing(Job &job, bool success);
+
+    /// Timer slot inserting the queued batches for at most one time slice.
+    void insertBatches();
+
+    void insertBatch(Batch const &batch);
+
+    void finish(bool success);
+
+private:
+    DataFlowGraphModel &_model;
+
+    int _timeSlice;
+
+    bool _running;
+
+    QTimer _timer;
+
+    std::shared_ptr<Job> _job;
+
+    std::thread _worker;
+
+    unsigned int _loadedNodes;
+
+    unsigned int _loadedConnections;
+};
+
+} // namespace QtNodes
@@ -11,9 +11,12 @@
 #include <QJsonObject>
 
 #include <memory>
+#include <tuple>
 
 namespace QtNodes {
 
+class DataFlowExecutor;
+
 class NODE_EDITOR_PUBLIC DataFlowGraphModel : public AbstractGraphModel, public Serializable
 {
     Q_OBJECT
@@ -25,11 +28,33 @@ public:
         QPointF pos;
     };
 
+    /// Defines how the data travels downstream after a node updates its outputs.
+    enum class PropagationMode {
+        /// Data is pushed depth-first through `setInData` right away.
+        Immediate,
+        /// Data is propagated in waves by a DataFlowExecutor, opted-in nodes run on a thread pool.
+        Threaded,
+        /**
+     * Data is propagated in waves by a DataFlowExecutor on the GUI thread:
+     * every changed node is evaluated once, in topological order.
+     */
+        Topological,
+    };
+
 public:
     DataFlowGraphModel(std::shared_ptr<NodeDelegateModelRegistry> registry);
 
+    ~DataFlowGraphModel() override;
+
     std::shared_ptr<NodeDelegateModelRegistry> dataModelRegistry() { return _registry; }
 
+    void setPropagationMode(PropagationMode mode);
+
+    PropagationMode propagationMode() const { return _propagationMode; }
+
+    /// Returns `nullptr` in the `Immediate` propagation mode.
+    DataFlowExecutor *executor() const { return _executor.get(); }
+
 public:
     std::unordered_set<NodeId> allNodeIds() const override;
 
@@ -51,6 +76,32 @@ public:
 
     QVariant nodeData(NodeId nodeId, NodeRole role) const override;
 
+    /// Returns the style stored in the node's delegate model without any JSON round-trip.
+    NodeStyle const &nodeStyle(NodeId nodeId) const override;
+
+    QSize nodeSize(NodeId nodeId) const override;
+
+    PortCount portCount(NodeId nodeId, PortType portType) const override;
+
+    bool nodeCaptionVisible(NodeId nodeId) const override;
+
+    QString nodeCaption(NodeId nodeId) const override;
+
+    QWidget *nodeWidget(NodeId nodeId) const override;
+
+    NodeDataType portDataType(NodeId nodeId, PortType portType, PortIndex index) const override;
+
+    /// Served from the handles cached by the node's delegate model.
+    DataTypeHandle portDataTypeHandle(NodeId nodeId,
+                                      PortType portType,
+                                      PortIndex index) const override;
+
+    bool portCaptionVisible(NodeId nodeId, PortType portType, PortIndex index) const override;
+
+    QString portCaption(NodeId nodeId, PortType portType, PortIndex index) const override;
+
+    bool portConnected(NodeId nodeId, PortType portType, PortIndex index) const override;
+
     NodeFlags nodeFlags(NodeId nodeId) const override;
 
     bool setNodeData(NodeId nodeId, NodeRole role, QVariant value) override;
@@ -76,8 +127,56 @@ public:
 
     void loadNode(QJsonObject const &nodeJson) override;
 
+    /// The model name followed by the delegate's `Serializable::saveBinary`.
+    QByteArray saveNodeState(NodeId const nodeId) const override;
+
+    void loadNodeState(NodeId const nodeId,
+                       QPointF const &position,
+                       QByteArray const &state) override;
+
     void load(QJsonObject const &json) override;
 
+    /**
+   * Writes the graph in a compact, versioned binary format. Nodes and
+   * connections are written in chunks of limited size, each node carrying
+   * the output of its delegate's `Serializable::saveBinary`.
+   */
+    void saveBinary(QDataStream &out) const override;
+
+    /**
+   * Reads the format written by `saveBinary` chunk by chunk. Sets the stream
+   * status to `QDataStream::ReadCorruptData` if the header is not recognized.
+   */
+    void loadBinary(QDataStream &in) override;
+
+    /// Checks the device for the binary format header without consuming it.
+    static bool isBinaryFormat(QIODevice *device);
+
+    /// One chunk of the binary format as stored in the stream.
+    struct BinaryChunk
+    {
+        quint32 tag = 0;
+        quint32 count = 0;
+        QByteArray payload;
+
+        bool holdsNodes() const;
+
+        bool holdsConnections() const;
+    };
+
+    /**
+   * Reads and checks the header written by `saveBinary`. Together with
+   * `readBinaryChunk` it lets the stream be parsed outside of the GUI thread,
+   * since neither function touches the model.
+   */
+    static bool readBinaryHeader(QDataStream &in);
+
+    /// @returns `false` after the last chunk or on a stream error.
+    static bool readBinaryChunk(QDataStream &in, BinaryChunk &chunk);
+
+    /// Restores the nodes or the connections stored in a chunk.
+    void loadBinaryChunk(BinaryChunk const &chunk);
+
     /**
    * Fetches the NodeDelegateModel for the given `nodeId` and tries to cast the
    * stored pointer to the given type
@@ -104,6 +203,19 @@ private:
 
     void sendConnectionDeletion(ConnectionId const connectionId);
 
+    /// Registers both ends of the connection in the per-port and per-node indices.
+    void indexConnection(ConnectionId const connectionId);
+
+    /// Removes the connection from the indices, dropping emptied buckets.
+    void unindexConnection(ConnectionId const connectionId);
+
+    /// Creates a delegate for a node restored with a known id.
+    NodeDelegateModel *restoreNode(NodeId const nodeId, QString const &modelName);
+
+    void saveNodeBinary(NodeId const nodeId, QDataStream &out) const;
+
+    void loadNodeBinary(QDataStream &in);
+
 private Q_SLOTS:
     /**
    * Fuction is called in three cases:
@@ -129,7 +241,23 @@ private:
 
     std::unordered_set<ConnectionId> _connectivity;
 
+    using PortKey = std::tuple<NodeId, PortType, PortIndex>;
+
+    /**
+   * Adjacency indices kept in sync with `_connectivity`. They let
+   * `connections()` and `allConnectionIds()` answer in O(degree) instead of
+   * scanning every connection in the graph.
+   */
+    std::unordered_map<PortKey, std::unordered_set<ConnectionId>> _portConnections;
+
+    std::unordered_map<NodeId, std::unordered_set<ConnectionId>> _nodeConnections;
+
     mutable std::unordered_map<NodeId, NodeGeometryData> _nodeGeometryData;
+
+    PropagationMode _propagationMode;
+
+    /// Declared after `_models` so that it is destroyed while the delegates still exist.
+    std::unique_ptr<DataFlowExecutor> _executor;
 };
 
 } // namespace QtNodes
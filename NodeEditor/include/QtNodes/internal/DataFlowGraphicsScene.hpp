@@ -1,6 +1,7 @@
 #pragma once
 
 #include "BasicGraphicsScene.hpp"
+#include "DataFlowGraphLoader.hpp"
 #include "DataFlowGraphModel.hpp"
 #include "Export.hpp"
 
@@ -25,6 +26,18 @@ public:
 public:
     QMenu *createSceneMenu(QPointF const scenePos) override;
 
+    /**
+   * When enabled, `load()` returns as soon as the file is opened. The graph
+   * is parsed on a worker thread and inserted in small batches by the
+   * DataFlowGraphLoader, with lazy graphics object creation switched on, and
+   * `sceneLoaded()` follows once the last batch is in. Disabled by default.
+   */
+    void setIncrementalLoading(bool incremental);
+
+    bool incrementalLoading() const { return _incrementalLoading; }
+
+    DataFlowGraphLoader &loader() { return _loader; }
+
 public Q_SLOTS:
     bool save() const;
 
@@ -35,6 +48,10 @@ Q_SIGNALS:
 
 private:
     DataFlowGraphModel &_graphModel;
+
+    bool _incrementalLoading;
+
+    DataFlowGraphLoader _loader;
 };
 
 } // namespace QtNodes
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "Export.hpp"
+#include "QStringStdHash.hpp"
+
+#include <QtCore/QReadWriteLock>
+#include <QtCore/QString>
+#include <QtGui/QColor>
+
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace QtNodes {
+
+/// Compact integer standing for an interned `NodeDataType::id`.
+using DataTypeHandle = unsigned int;
+
+static constexpr DataTypeHandle InvalidDataTypeHandle = std::numeric_limits<DataTypeHandle>::max();
+
+/**
+ * Process-wide table of the data type ids seen so far.
+ *
+ * Every id string is hashed once, when it is interned, and mapped to a small
+ * integer handle. Whatever is derived from the id alone, like the data-defined
+ * connection color, is computed at that point and afterwards looked up by
+ * handle. The registry is safe to use from the executor's worker threads.
+ */
+class NODE_EDITOR_PUBLIC DataTypeRegistry
+{
+public:
+    static DataTypeRegistry &instance();
+
+    DataTypeRegistry(DataTypeRegistry const &) = delete;
+
+    DataTypeRegistry &operator=(DataTypeRegistry const &) = delete;
+
+public:
+    /// @returns the handle of `typeId`, registering the id on first use.
+    DataTypeHandle intern(QString const &typeId);
+
+    /// @returns an empty string for unknown handles.
+    QString typeId(DataTypeHandle handle) const;
+
+    /// Color used for connections and ports when `ConnectionStyle::useDataDefinedColors()` is set.
+    QColor color(DataTypeHandle handle) const;
+
+    std::size_t size() const;
+
+private:
+    DataTypeRegistry() = default;
+
+    /// The pseudo-random color derived from the id's hash.
+    static QColor computeColor(QString const &typeId);
+
+private:
+    struct Entry
+    {
+        QString typeId;
+
+        QColor color;
+    };
+
+    mutable QReadWriteLock _lock;
+
+    std::unordered_map<QString, DataTypeHandle> _handles;
+
+    std::vector<Entry> _entries;
+};
+
+} // namespace QtNodes
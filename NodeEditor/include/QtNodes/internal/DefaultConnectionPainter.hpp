@@ -21,6 +21,9 @@ private:
     void drawSketchLine(QPainter *painter, ConnectionGraphicsObject const &cgo) const;
     void drawHoveredOrSelected(QPainter *painter, ConnectionGraphicsObject const &cgo) const;
     void drawNormalLine(QPainter *painter, ConnectionGraphicsObject const &cgo) const;
+    void drawSimplifiedLine(QPainter *painter,
+                            ConnectionGraphicsObject const &cgo,
+                            LevelOfDetail lod) const;
 #ifdef NODE_DEBUG_DRAWING
     void debugDrawing(QPainter *painter, ConnectionGraphicsObject const &cgo) const;
 #endif
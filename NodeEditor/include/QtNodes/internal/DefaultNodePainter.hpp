@@ -4,6 +4,7 @@
 
 #include "AbstractNodePainter.hpp"
 #include "Definitions.hpp"
+#include "NodeRenderInfo.hpp"
 
 namespace QtNodes {
 
@@ -19,16 +20,42 @@ class NODE_EDITOR_PUBLIC DefaultNodePainter : public AbstractNodePainter
 public:
     void paint(QPainter *painter, NodeGraphicsObject &ngo) const override;
 
-    void drawNodeRect(QPainter *painter, NodeGraphicsObject &ngo) const;
+    /**
+   * Stretches a pre-blurred nine-patch pixmap around the node, so that every
+   * shadow is a single blit. The pixmap is built once per shadow color and
+   * kept in QPixmapCache.
+   */
+    void drawShadow(QPainter *painter, NodeRenderInfo const &info) const;
 
-    void drawConnectionPoints(QPainter *painter, NodeGraphicsObject &ngo) const;
+    void drawNodeRect(QPainter *painter,
+                      NodeGraphicsObject &ngo,
+                      NodeRenderInfo const &info) const;
 
-    void drawFilledConnectionPoints(QPainter *painter, NodeGraphicsObject &ngo) const;
+    /// Unrounded single-color body used below `LevelOfDetail::Full`.
+    void drawFlatNodeRect(QPainter *painter,
+                          NodeGraphicsObject &ngo,
+                          NodeRenderInfo const &info) const;
 
-    void drawNodeCaption(QPainter *painter, NodeGraphicsObject &ngo) const;
+    void drawConnectionPoints(QPainter *painter,
+                              NodeGraphicsObject &ngo,
+                              NodeRenderInfo const &info) const;
 
-    void drawEntryLabels(QPainter *painter, NodeGraphicsObject &ngo) const;
+    void drawFilledConnectionPoints(QPainter *painter,
+                                    NodeGraphicsObject &ngo,
+                                    NodeRenderInfo const &info) const;
+
+    void drawNodeCaption(QPainter *painter,
+                         NodeGraphicsObject &ngo,
+                         NodeRenderInfo const &info) const;
+
+    void drawEntryLabels(QPainter *painter,
+                         NodeGraphicsObject &ngo,
+                         NodeRenderInfo const &info) const;
 
     void drawResizeRect(QPainter *painter, NodeGraphicsObject &ngo) const;
+
+private:
+    /// Reused between paint calls to keep the port vectors allocated.
+    mutable NodeRenderInfo _renderInfo;
 };
 } // namespace QtNodes
@@ -4,6 +4,9 @@
 
 #include <QtGui/QFontMetrics>
 
+#include <unordered_map>
+#include <vector>
+
 namespace QtNodes {
 
 class AbstractGraphModel;
@@ -35,16 +38,68 @@ public:
 
     QRect resizeHandleRect(NodeId const nodeId) const override;
 
+    void invalidateLayout(NodeId const nodeId) const override;
+
 private:
-    QRectF portTextRect(NodeId const nodeId,
-                        PortType const portType,
-                        PortIndex const portIndex) const;
-    /// Finds
-    unsigned int maxHorizontalPortsExtent(NodeId const nodeId) const;
+    struct PortLayout
+    {
+        QRectF textRect;
+
+        QPointF position;
+
+        QPointF textPosition;
+    };
+
+    /**
+   * Per-node results of the font metrics and model queries. The measured part
+   * only changes with the ports, the caption or the widget and is dropped by
+   * `recomputeSize`, the positions are redone whenever the node size differs
+   * from `size`.
+   */
+    struct NodeLayout
+    {
+        struct Ports
+        {
+            unsigned int maxTextAdvance = 0;
+
+            /// Room reserved for the port labels above or below the node body.
+            unsigned int captionsHeight = 0;
+
+            std::vector<PortLayout> ports;
+        };
+
+        Ports &ports(PortType const portType) { return portType == PortType::In ? in : out; }
+
+        bool placed = false;
+
+        QSize size;
 
-    unsigned int maxPortsTextAdvance(NodeId const nodeId, PortType const portType) const;
+        QRectF captionRect;
 
-    unsigned int portCaptionsHeight(NodeId const nodeId, PortType const portType) const;
+        QPointF captionPosition;
+
+        bool hasWidget = false;
+
+        bool widgetExpanding = false;
+
+        int widgetHeight = 0;
+
+        QPointF widgetPosition;
+
+        Ports in;
+
+        Ports out;
+    };
+
+    /// The layout with its size independent part filled in.
+    NodeLayout &measuredLayout(NodeId const nodeId) const;
+
+    /// The layout with the positions matching the current node size.
+    NodeLayout &layout(NodeId const nodeId) const;
+
+    PortLayout const &portLayout(NodeId const nodeId,
+                                 PortType const portType,
+                                 PortIndex const portIndex) const;
 
 private:
     // Some variables are mutable because we need to change drawing
@@ -55,6 +110,8 @@ private:
     unsigned int _portSpasing;
     mutable QFontMetrics _fontMetrics;
     mutable QFontMetrics _boldFontMetrics;
+
+    mutable std::unordered_map<NodeId, NodeLayout> _layouts;
 };
 
 } // namespace QtNodes
@@ -80,6 +80,17 @@ enum class PortType {
 };
 Q_ENUM_NS(PortType)
 
+/**
+ * How much of the nodes and connections gets drawn, picked by the scene from
+ * the view scale. @see BasicGraphicsScene::levelOfDetail
+ */
+enum class LevelOfDetail {
+    Full = 0,    ///< Everything, including shadows and embedded widgets.
+    Reduced = 1, ///< Flat node bodies with captions, no ports, labels or widgets.
+    Minimal = 2, ///< Plain rectangles and straight connection lines.
+};
+Q_ENUM_NS(LevelOfDetail)
+
 using PortCount = unsigned int;
 
 /// ports are consecutively numbered starting from zero.
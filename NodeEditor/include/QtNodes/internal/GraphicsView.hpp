@@ -1,5 +1,6 @@
 #pragma once
 
+#include <QtGui/QPixmap>
 #include <QtWidgets/QGraphicsView>
 
 #include "Export.hpp"
@@ -78,12 +79,23 @@ protected:
 
     void showEvent(QShowEvent *event) override;
 
+    /// Reports the visible part of the scene before painting it.
+    void paintEvent(QPaintEvent *event) override;
+
 protected:
     BasicGraphicsScene *nodeScene();
 
     /// Computes scene position for pasting the copied/duplicated node groups.
     QPointF scenePastePosition();
 
+private:
+    /**
+   * One coarse grid cell with its fine lines, rendered for `deviceScale`
+   * device pixels per scene unit. Rebuilt only when zooming or when the
+   * style colors change, panning reuses it.
+   */
+    QPixmap const &gridTile(qreal deviceScale);
+
 private:
     QAction *_clearSelectionAction = nullptr;
     QAction *_deleteSelectionAction = nullptr;
@@ -93,5 +105,9 @@ private:
 
     QPointF _clickPos;
     ScaleRange _scaleRange;
+
+    QPixmap _gridTile;
+    qreal _gridTileScale = 0.0;
+    QRgb _gridTileColors[2] = {0, 0};
 };
 } // namespace QtNodes
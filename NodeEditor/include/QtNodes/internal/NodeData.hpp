@@ -1,10 +1,12 @@
 #pragma once
 
+#include <atomic>
 #include <memory>
 
 #include <QtCore/QObject>
 #include <QtCore/QString>
 
+#include "DataTypeRegistry.hpp"
 #include "Export.hpp"
 
 namespace QtNodes {
@@ -27,15 +29,45 @@ struct NODE_EDITOR_PUBLIC NodeDataType
 class NODE_EDITOR_PUBLIC NodeData
 {
 public:
+    NodeData() = default;
+
+    NodeData(NodeData const &other)
+        : _typeHandle(other._typeHandle.load(std::memory_order_relaxed))
+    {}
+
+    /// Keeps the cached handle, the dynamic type of `*this` does not change.
+    NodeData &operator=(NodeData const &) { return *this; }
+
     virtual ~NodeData() = default;
 
     virtual bool sameType(NodeData const &nodeData) const
     {
-        return (this->type().id == nodeData.type().id);
+        return typeHandle() == nodeData.typeHandle();
     }
 
     /// Type for inner use
     virtual NodeDataType type() const = 0;
+
+    /**
+   * `type().id` interned on the first call, so that repeated type checks on
+   * the same data object are integer compares. Assumes `type()` does not
+   * change over the lifetime of the object.
+   */
+    DataTypeHandle typeHandle() const
+    {
+        DataTypeHandle handle = _typeHandle.load(std::memory_order_relaxed);
+
+        if (handle == InvalidDataTypeHandle) {
+            handle = DataTypeRegistry::instance().intern(type().id);
+            _typeHandle.store(handle, std::memory_order_relaxed);
+        }
+
+        return handle;
+    }
+
+private:
+    /// Atomic since the data travels through the executor's worker threads.
+    mutable std::atomic<DataTypeHandle> _typeHandle{InvalidDataTypeHandle};
 };
 
 } // namespace QtNodes
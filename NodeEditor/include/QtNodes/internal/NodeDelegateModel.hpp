@@ -1,6 +1,8 @@
 #pragma once
 
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include <QtWidgets/QWidget>
 
@@ -54,6 +56,17 @@ public:
 
     virtual NodeDataType dataType(PortType portType, PortIndex portIndex) const = 0;
 
+    /**
+   * `dataType(portType, portIndex).id` interned and cached per port.
+   *
+   * The cache is dropped whenever the model emits `dataUpdated`,
+   * `embeddedWidgetSizeUpdated`, `portsInserted` or `portsDeleted`, which
+   * covers models deriving their port types from the input data or from
+   * their widget. A model changing a port type without emitting any of them
+   * must call `invalidateDataTypeHandles()` itself.
+   */
+    DataTypeHandle dataTypeHandle(PortType portType, PortIndex portIndex) const;
+
 public:
     virtual ConnectionPolicy portConnectionPolicy(PortType, PortIndex) const;
 
@@ -66,6 +79,21 @@ public:
 
     virtual std::shared_ptr<NodeData> outData(PortIndex const port) = 0;
 
+    /**
+   * Receives all the inputs changed within one propagation wave of
+   * DataFlowExecutor.
+   *
+   * The default implementation forwards every entry to `setInData()`, with
+   * `moreInDataPending()` returning `true` for all but the last one. A model
+   * whose `setInData()` stores the input and returns early while more data
+   * is pending recomputes once per wave; otherwise it recomputes once per
+   * changed port and should reimplement this function instead. Either way
+   * the `dataUpdated` signals emitted during the call reach the downstream
+   * nodes only once, after it returns.
+   */
+    virtual void setInDataBatch(
+        std::vector<std::pair<PortIndex, std::shared_ptr<NodeData>>> const &inputs);
+
     /**
    * It is recommented to preform a lazy initialization for the
    * embedded widget and create it inside this function, not in the
@@ -80,6 +108,33 @@ public:
 
     virtual bool resizable() const { return false; }
 
+public:
+    /**
+   * Opt-in for `DataFlowGraphModel::PropagationMode::Threaded`. Models
+   * returning `true` are evaluated on a worker thread through `compute()`
+   * instead of receiving their inputs through `setInData()`.
+   */
+    virtual bool computeInBackground() const { return false; }
+
+    /**
+   * Evaluates the node on a worker thread. `inputs` holds the data of every
+   * input port (`nullptr` for unconnected ports); the returned vector holds
+   * the data for the output ports.
+   *
+   * The function must not touch widgets or any state that is modified on
+   * the GUI thread while it is running.
+   */
+    virtual std::vector<std::shared_ptr<NodeData>> compute(
+        std::vector<std::shared_ptr<NodeData>> const &inputs) const;
+
+    /**
+   * Receives the result of `compute()` back on the GUI thread. Reimplement
+   * it to store `outputs` so that `outData()` returns them afterwards and to
+   * update the embedded widget.
+   */
+    virtual void setComputedData(std::vector<std::shared_ptr<NodeData>> const &inputs,
+                                 std::vector<std::shared_ptr<NodeData>> const &outputs);
+
 public Q_SLOTS:
 
     virtual void inputConnectionCreated(ConnectionId const &) {}
@@ -126,8 +181,20 @@ Q_SIGNALS:
     /// Call this function when data and port moditications are finished.
     void portsInserted();
 
+protected:
+    void invalidateDataTypeHandles();
+
+    /// `true` inside `setInData()` when the default `setInDataBatch()` has more ports to deliver.
+    bool moreInDataPending() const { return _moreInDataPending; }
+
 private:
     NodeStyle _nodeStyle;
+
+    bool _moreInDataPending;
+
+    mutable std::vector<DataTypeHandle> _inTypeHandles;
+
+    mutable std::vector<DataTypeHandle> _outTypeHandles;
 };
 
 } // namespace QtNodes
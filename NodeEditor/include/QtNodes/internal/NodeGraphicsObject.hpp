@@ -1,6 +1,8 @@
 #pragma once
 
+#include <QtCore/QPointer>
 #include <QtCore/QUuid>
+#include <QtGui/QPixmap>
 #include <QtWidgets/QGraphicsObject>
 
 #include "NodeState.hpp"
@@ -24,7 +26,7 @@ public:
 public:
     NodeGraphicsObject(BasicGraphicsScene &scene, NodeId node);
 
-    ~NodeGraphicsObject() override = default;
+    ~NodeGraphicsObject() override;
 
 public:
     AbstractGraphModel &graphModel() const;
@@ -39,6 +41,13 @@ public:
 
     NodeState const &nodeState() const { return _nodeState; }
 
+    /// Increases with every node object added to a scene.
+    /**
+   * Items with equal z values are drawn in the order they were added, so the
+   * node with the larger value is on top.
+   */
+    quint64 insertionOrder() const { return _insertionOrder; }
+
     QRectF boundingRect() const override;
 
     void setGeometryChanged();
@@ -52,6 +61,19 @@ public:
 
     void updateQWidgetEmbedPos();
 
+    /// Shows the embedded widget only at `LevelOfDetail::Full`.
+    void updateLevelOfDetail();
+
+    /// Whether the model's widget currently lives in a QGraphicsProxyWidget.
+    bool widgetEmbedded() const { return _proxyWidget != nullptr; }
+
+    /**
+   * Moves the model's widget into a proxy or takes it out again. A detached
+   * widget is painted from a snapshot grabbed when it left its proxy, which
+   * is not refreshed until the widget is embedded again.
+   */
+    void setWidgetEmbedded(bool embedded);
+
 protected:
     void paint(QPainter *painter,
                QStyleOptionGraphicsItem const *option,
@@ -83,11 +105,18 @@ private:
 private:
     NodeId _nodeId;
 
+    quint64 _insertionOrder;
+
     AbstractGraphModel &_graphModel;
 
     NodeState _nodeState;
 
     // either nullptr or owned by parent QGraphicsItem
     QGraphicsProxyWidget *_proxyWidget;
+
+    /// The widget taken out of its proxy, owned by the node object meanwhile.
+    QPointer<QWidget> _detachedWidget;
+
+    QPixmap _widgetSnapshot;
 };
 } // namespace QtNodes
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <vector>
+
+#include <QtCore/QSize>
+#include <QtCore/QString>
+
+#include "DataTypeRegistry.hpp"
+#include "Definitions.hpp"
+#include "NodeData.hpp"
+
+namespace QtNodes {
+
+class NodeStyle;
+
+/// Per-port part of the `NodeRenderInfo` snapshot.
+struct PortRenderInfo
+{
+    NodeDataType dataType;
+
+    /// `dataType.id` interned, for color lookups.
+    DataTypeHandle typeHandle = InvalidDataTypeHandle;
+
+    /// Port caption if it is visible, the data type name otherwise.
+    QString label;
+
+    bool connected = false;
+};
+
+/**
+ * A strongly typed snapshot of everything the default painter needs in order
+ * to draw a single node. It is filled once per paint call by
+ * `AbstractGraphModel::fillRenderInfo`, so the draw routines do not have to
+ * query the model through `QVariant` for every port.
+ *
+ * The `style` pointer is owned by the graph model and stays valid until the
+ * node is updated or deleted.
+ */
+struct NodeRenderInfo
+{
+    NodeId nodeId = InvalidNodeId;
+
+    QSize size;
+
+    bool captionVisible = false;
+
+    QString caption;
+
+    NodeStyle const *style = nullptr;
+
+    std::vector<PortRenderInfo> inPorts;
+
+    std::vector<PortRenderInfo> outPorts;
+
+    std::vector<PortRenderInfo> const &ports(PortType portType) const
+    {
+        return (portType == PortType::In) ? inPorts : outPorts;
+    }
+
+    std::vector<PortRenderInfo> &ports(PortType portType)
+    {
+        return (portType == PortType::In) ? inPorts : outPorts;
+    }
+};
+
+} // namespace QtNodes
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <QtCore/QByteArray>
+#include <QtCore/QDataStream>
+#include <QtCore/QJsonDocument>
 #include <QtCore/QJsonObject>
 
 namespace QtNodes {
@@ -12,5 +15,24 @@ public:
     virtual QJsonObject save() const { return {}; }
 
     virtual void load(QJsonObject const & /*p*/) {}
+
+    /**
+   * Binary counterpart of `save()`. The default implementation writes the
+   * JSON object as compact text, so only classes that reimplement both
+   * `saveBinary` and `loadBinary` benefit from the binary format.
+   */
+    virtual void saveBinary(QDataStream &out) const
+    {
+        out << QJsonDocument(save()).toJson(QJsonDocument::Compact);
+    }
+
+    /// Binary counterpart of `load()`, must read exactly what `saveBinary` wrote.
+    virtual void loadBinary(QDataStream &in)
+    {
+        QByteArray json;
+        in >> json;
+
+        load(QJsonDocument::fromJson(json).object());
+    }
 };
 } // namespace QtNodes
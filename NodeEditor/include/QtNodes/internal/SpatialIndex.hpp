@@ -0,0 +1,261 @@
+#pragma once
+
+#include <QtCore/QRectF>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace QtNodes {
+
+/**
+ * A uniform grid of axis-aligned boxes keyed by `Key`.
+ *
+ * Every box is stored in each grid cell it overlaps. Updating a box only
+ * touches the grid when it enters or leaves a cell, so the small moves of an
+ * interactive drag cost a comparison of two cell ranges. Queries visit the
+ * cells overlapping the query rect only, so hit tests and viewport culling
+ * do not depend on the total number of stored boxes.
+ *
+ * Boxes spanning more than `MaxCellsPerBox` cells, like long connections,
+ * are kept in a separate list checked by every query.
+ */
+template<typename Key>
+class SpatialIndex
+{
+public:
+    static constexpr int MaxCellsPerBox = 64;
+
+public:
+    explicit SpatialIndex(qreal cellSize = 256.0)
+        : _cellSize(cellSize)
+        , _stamp(0)
+    {}
+
+    /// Inserts the box or moves an existing one.
+    void insert(Key const &key, QRectF const &rect)
+    {
+        CellRange const cells = cellRange(rect);
+
+        auto it = _entries.find(key);
+
+        if (it != _entries.end()) {
+            it->second.rect = rect;
+
+            if (it->second.cells == cells)
+                return;
+
+            unlink(key, it->second.cells);
+            it->second.cells = cells;
+        } else {
+            _entries.emplace(key, Entry{rect, cells, 0});
+        }
+
+        link(key, cells);
+    }
+
+    void remove(Key const &key)
+    {
+        auto it = _entries.find(key);
+
+        if (it == _entries.end())
+            return;
+
+        unlink(key, it->second.cells);
+
+        _entries.erase(it);
+    }
+
+    void clear()
+    {
+        _entries.clear();
+        _cells.clear();
+        _oversized.clear();
+    }
+
+    bool contains(Key const &key) const { return _entries.count(key) > 0; }
+
+    std::size_t size() const { return _entries.size(); }
+
+    /// Calls `visitor(key, box)` once for every box touching `rect`.
+    template<typename Visitor>
+    void query(QRectF const &rect, Visitor &&visitor) const
+    {
+        ++_stamp;
+
+        auto visit = [&](Key const &key) {
+            Entry const &entry = _entries.find(key)->second;
+
+            if (entry.stamp == _stamp)
+                return;
+
+            entry.stamp = _stamp;
+
+            if (touches(entry.rect, rect))
+                visitor(key, entry.rect);
+        };
+
+        for (Key const &key : _oversized) {
+            visit(key);
+        }
+
+        CellRange const cells = cellRange(rect);
+
+        // A huge query rect is cheaper to answer by scanning the boxes.
+        if (cells.count() > static_cast<qint64>(_entries.size())) {
+            for (auto const &p : _entries) {
+                visit(p.first);
+            }
+
+            return;
+        }
+
+        for (int y = cells.top; y <= cells.bottom; ++y) {
+            for (int x = cells.left; x <= cells.right; ++x) {
+                auto it = _cells.find(cellKey(x, y));
+
+                if (it == _cells.end())
+                    continue;
+
+                for (Key const &key : it->second) {
+                    visit(key);
+                }
+            }
+        }
+    }
+
+    std::vector<Key> query(QRectF const &rect) const
+    {
+        std::vector<Key> result;
+
+        query(rect, [&result](Key const &key, QRectF const &) { result.push_back(key); });
+
+        return result;
+    }
+
+private:
+    struct CellRange
+    {
+        int left;
+        int top;
+        int right;
+        int bottom;
+
+        qint64 count() const
+        {
+            return static_cast<qint64>(right - left + 1) * static_cast<qint64>(bottom - top + 1);
+        }
+
+        bool operator==(CellRange const &other) const
+        {
+            return left == other.left && top == other.top && right == other.right
+                   && bottom == other.bottom;
+        }
+    };
+
+    struct Entry
+    {
+        QRectF rect;
+
+        CellRange cells;
+
+        /// Last query which visited the entry, avoids reporting it once per cell.
+        mutable std::uint64_t stamp;
+    };
+
+private:
+    /// Unlike `QRectF::intersects` accepts empty rects, so points can be queried too.
+    static bool touches(QRectF const &a, QRectF const &b)
+    {
+        QRectF const na = a.normalized();
+        QRectF const nb = b.normalized();
+
+        return na.left() <= nb.right() && nb.left() <= na.right() && na.top() <= nb.bottom()
+               && nb.top() <= na.bottom();
+    }
+
+    int cellCoordinate(qreal value) const
+    {
+        qreal const cell = std::floor(value / _cellSize);
+
+        // Keeps absurd coordinates from overflowing.
+        return static_cast<int>(std::max<qreal>(-1e6, std::min<qreal>(1e6, cell)));
+    }
+
+    CellRange cellRange(QRectF const &rect) const
+    {
+        QRectF const r = rect.normalized();
+
+        return CellRange{cellCoordinate(r.left()),
+                         cellCoordinate(r.top()),
+                         cellCoordinate(r.right()),
+                         cellCoordinate(r.bottom())};
+    }
+
+    static std::uint64_t cellKey(int x, int y)
+    {
+        return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(x)) << 32)
+               | static_cast<std::uint32_t>(y);
+    }
+
+    void link(Key const &key, CellRange const &cells)
+    {
+        if (cells.count() > MaxCellsPerBox) {
+            _oversized.push_back(key);
+            return;
+        }
+
+        for (int y = cells.top; y <= cells.bottom; ++y) {
+            for (int x = cells.left; x <= cells.right; ++x) {
+                _cells[cellKey(x, y)].push_back(key);
+            }
+        }
+    }
+
+    static void eraseKey(std::vector<Key> &keys, Key const &key)
+    {
+        auto it = std::find(keys.begin(), keys.end(), key);
+
+        if (it != keys.end()) {
+            *it = keys.back();
+            keys.pop_back();
+        }
+    }
+
+    void unlink(Key const &key, CellRange const &cells)
+    {
+        if (cells.count() > MaxCellsPerBox) {
+            eraseKey(_oversized, key);
+            return;
+        }
+
+        for (int y = cells.top; y <= cells.bottom; ++y) {
+            for (int x = cells.left; x <= cells.right; ++x) {
+                auto it = _cells.find(cellKey(x, y));
+
+                if (it == _cells.end())
+                    continue;
+
+                eraseKey(it->second, key);
+
+                if (it->second.empty())
+                    _cells.erase(it);
+            }
+        }
+    }
+
+private:
+    qreal _cellSize;
+
+    std::unordered_map<Key, Entry> _entries;
+
+    std::unordered_map<std::uint64_t, std::vector<Key>> _cells;
+
+    std::vector<Key> _oversized;
+
+    mutable std::uint64_t _stamp;
+};
+
+} // namespace QtNodes
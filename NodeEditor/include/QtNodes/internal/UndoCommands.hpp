@@ -3,16 +3,76 @@
 #include "Definitions.hpp"
 
 #include <QUndoCommand>
+#include <QtCore/QByteArray>
+#include <QtCore/QJsonArray>
 #include <QtCore/QJsonObject>
 #include <QtCore/QPointF>
 
+#include <cstddef>
 #include <unordered_set>
+#include <vector>
 
 namespace QtNodes {
 
 class BasicGraphicsScene;
 
-class CreateCommand : public QUndoCommand
+/**
+ * A group of nodes and connections taken out of the graph or put into it by
+ * an undo command. Node states are kept in the compact form written by
+ * `AbstractGraphModel::saveNodeState`. Ids and positions are plain values
+ * next to them, so remapping or shifting a group does not touch the states.
+ */
+struct GraphDiff
+{
+    struct Node
+    {
+        NodeId id;
+
+        QPointF position;
+
+        /// Output of `AbstractGraphModel::saveNodeState`.
+        QByteArray state;
+    };
+
+    std::vector<Node> nodes;
+
+    /// Every connection is listed once.
+    std::vector<ConnectionId> connections;
+
+    bool empty() const { return nodes.empty() && connections.empty(); }
+
+    /// Approximate heap usage, as of the last `updateMemoryCost()`.
+    std::size_t memoryCost() const { return _memoryCost; }
+
+    /// Called once the diff is built, so the undo memory limit only sums cached values.
+    void updateMemoryCost();
+
+    void clear();
+
+private:
+    std::size_t _memoryCost = 0;
+};
+
+/**
+ * Base of the commands keeping a GraphDiff. The scene accounts their diffs
+ * against `BasicGraphicsScene::undoMemoryLimit()`.
+ */
+class DiffCommand : public QUndoCommand
+{
+public:
+    GraphDiff const &diff() const { return _diff; }
+
+    /**
+   * Releases the diff and marks the command obsolete, so QUndoStack drops it
+   * instead of undoing it once it is reached.
+   */
+    void expire();
+
+protected:
+    GraphDiff _diff;
+};
+
+class CreateCommand : public DiffCommand
 {
 public:
     CreateCommand(BasicGraphicsScene *scene, QString const name, QPointF const &mouseScenePos);
@@ -23,14 +83,13 @@ public:
 private:
     BasicGraphicsScene *_scene;
     NodeId _nodeId;
-    QJsonObject _sceneJson;
 };
 
 /**
- * Selected scene objects are serialized and then removed from the scene.
- * The deleted elements could be restored in `undo`.
+ * Selected scene objects are recorded in a GraphDiff and then removed from
+ * the scene. The deleted elements could be restored in `undo`.
  */
-class DeleteCommand : public QUndoCommand
+class DeleteCommand : public DiffCommand
 {
 public:
     DeleteCommand(BasicGraphicsScene *scene);
@@ -40,7 +99,6 @@ public:
 
 private:
     BasicGraphicsScene *_scene;
-    QJsonObject _sceneJson;
 };
 
 class CopyCommand : public QUndoCommand
@@ -49,7 +107,7 @@ public:
     CopyCommand(BasicGraphicsScene *scene);
 };
 
-class PasteCommand : public QUndoCommand
+class PasteCommand : public DiffCommand
 {
 public:
     PasteCommand(BasicGraphicsScene *scene, QPointF const &mouseScenePos);
@@ -59,12 +117,16 @@ public:
 
 private:
     QJsonObject takeSceneJsonFromClipboard();
-    QJsonObject makeNewNodeIdsInScene(QJsonObject const &sceneJson);
+    void makeNewNodeIdsInScene();
 
 private:
     BasicGraphicsScene *_scene;
-    QPointF const &_mouseScenePos;
-    QJsonObject _newSceneJson;
+
+    /**
+   * The pasted node objects, inserted with `loadNode` on the first redo.
+   * Dropped once the first undo has captured the compact node states.
+   */
+    QJsonArray _pastedNodes;
 };
 
 class DisconnectCommand : public QUndoCommand
@@ -100,20 +162,18 @@ class MoveNodeCommand : public QUndoCommand
 public:
     MoveNodeCommand(BasicGraphicsScene *scene, QPointF const &diff);
 
+    /// Moves the given nodes instead of the current selection.
+    MoveNodeCommand(BasicGraphicsScene *scene, std::unordered_set<NodeId> nodes, QPointF const &diff);
+
     void undo() override;
     void redo() override;
 
     /**
-   * A command ID is used in command compression. It must be an integer unique to
-   * this command's class, or -1 if the command doesn't support compression.
+   * Returns -1: every drag session pushes one command on release, and each
+   * of them stays a separate undo step.
    */
     int id() const override;
 
-    /**
-   * Several sequential movements could be merged into one command.
-   */
-    bool mergeWith(QUndoCommand const *c) override;
-
 private:
     BasicGraphicsScene *_scene;
     std::unordered_set<NodeId> _selectedNodes;
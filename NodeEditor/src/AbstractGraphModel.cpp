@@ -2,8 +2,250 @@
 
 #include <QtNodes/ConnectionIdUtils>
 
+#include <QtCore/QJsonDocument>
+#include <QtWidgets/QWidget>
+
+#include "NodeRenderInfo.hpp"
+
+#include <utility>
+
 namespace QtNodes {
 
+AbstractGraphModel::AbstractGraphModel()
+    : _batchDepth(0)
+{
+    connect(this, &AbstractGraphModel::nodeUpdated, this, [this](NodeId const nodeId) {
+        invalidateNodeStyle(nodeId);
+    });
+
+    connect(this, &AbstractGraphModel::nodeDeleted, this, [this](NodeId const nodeId) {
+        invalidateNodeStyle(nodeId);
+    });
+
+    connect(this, &AbstractGraphModel::modelReset, this, [this]() { _nodeStyleCache.clear(); });
+
+    // Batch bookkeeping.
+
+    connect(this, &AbstractGraphModel::nodeCreated, this, [this](NodeId const nodeId) {
+        if (inBatch())
+            _batch.createdNodes.insert(nodeId);
+    });
+
+    connect(this, &AbstractGraphModel::nodeDeleted, this, [this](NodeId const nodeId) {
+        if (inBatch())
+            _batch.deletedNodes.insert(nodeId);
+    });
+
+    connect(this, &AbstractGraphModel::nodeUpdated, this, [this](NodeId const nodeId) {
+        if (inBatch())
+            _batch.updatedNodes.insert(nodeId);
+    });
+
+    connect(this, &AbstractGraphModel::nodePositionUpdated, this, [this](NodeId const nodeId) {
+        if (inBatch())
+            _batch.movedNodes.insert(nodeId);
+    });
+
+    connect(this, &AbstractGraphModel::connectionCreated, this, [this](ConnectionId const cid) {
+        if (inBatch())
+            _batch.createdConnections.insert(cid);
+    });
+
+    connect(this, &AbstractGraphModel::connectionDeleted, this, [this](ConnectionId const cid) {
+        if (inBatch())
+            _batch.deletedConnections.insert(cid);
+    });
+}
+
+QByteArray AbstractGraphModel::saveNodeState(NodeId const nodeId) const
+{
+    return QJsonDocument(saveNode(nodeId)).toJson(QJsonDocument::Compact);
+}
+
+void AbstractGraphModel::loadNodeState(NodeId const nodeId,
+                                       QPointF const &position,
+                                       QByteArray const &state)
+{
+    QJsonObject nodeJson = QJsonDocument::fromJson(state).object();
+
+    nodeJson["id"] = static_cast<qint64>(nodeId);
+
+    QJsonObject posJson;
+    posJson["x"] = position.x();
+    posJson["y"] = position.y();
+    nodeJson["position"] = posJson;
+
+    loadNode(nodeJson);
+}
+
+void AbstractGraphModel::recordUpdatedNode(NodeId const nodeId)
+{
+    if (inBatch())
+        _batch.updatedNodes.insert(nodeId);
+}
+
+void AbstractGraphModel::beginBatch()
+{
+    ++_batchDepth;
+}
+
+void AbstractGraphModel::endBatch()
+{
+    Q_ASSERT(_batchDepth > 0);
+
+    if (--_batchDepth > 0)
+        return;
+
+    BatchRecord record;
+    std::swap(record, _batch);
+
+    GraphChanges changes;
+
+    // Ids may be reused within the batch, a node deleted and created again
+    // shows up on both lists.
+    changes.deletedNodes.assign(record.deletedNodes.begin(), record.deletedNodes.end());
+    changes.deletedConnections.assign(record.deletedConnections.begin(),
+                                      record.deletedConnections.end());
+
+    for (NodeId const nodeId : record.createdNodes) {
+        if (nodeExists(nodeId))
+            changes.createdNodes.push_back(nodeId);
+    }
+
+    for (NodeId const nodeId : record.updatedNodes) {
+        if (record.createdNodes.count(nodeId) == 0 && nodeExists(nodeId))
+            changes.updatedNodes.push_back(nodeId);
+    }
+
+    for (NodeId const nodeId : record.movedNodes) {
+        if (record.createdNodes.count(nodeId) == 0 && nodeExists(nodeId))
+            changes.movedNodes.push_back(nodeId);
+    }
+
+    for (ConnectionId const &cid : record.createdConnections) {
+        if (connectionExists(cid))
+            changes.createdConnections.push_back(cid);
+    }
+
+    if (!changes.empty())
+        Q_EMIT graphChanged(changes);
+}
+
+NodeStyle const &AbstractGraphModel::nodeStyle(NodeId nodeId) const
+{
+    auto it = _nodeStyleCache.find(nodeId);
+
+    if (it == _nodeStyleCache.end()) {
+        QJsonDocument json = QJsonDocument::fromVariant(nodeData(nodeId, NodeRole::Style));
+
+        it = _nodeStyleCache.emplace(nodeId, NodeStyle(json.object())).first;
+    }
+
+    return it->second;
+}
+
+QSize AbstractGraphModel::nodeSize(NodeId nodeId) const
+{
+    return nodeData<QSize>(nodeId, NodeRole::Size);
+}
+
+PortCount AbstractGraphModel::portCount(NodeId nodeId, PortType portType) const
+{
+    auto portCountRole = portType == PortType::In ? NodeRole::InPortCount : NodeRole::OutPortCount;
+
+    return nodeData<PortCount>(nodeId, portCountRole);
+}
+
+bool AbstractGraphModel::nodeCaptionVisible(NodeId nodeId) const
+{
+    return nodeData<bool>(nodeId, NodeRole::CaptionVisible);
+}
+
+QString AbstractGraphModel::nodeCaption(NodeId nodeId) const
+{
+    return nodeData<QString>(nodeId, NodeRole::Caption);
+}
+
+QWidget *AbstractGraphModel::nodeWidget(NodeId nodeId) const
+{
+    return nodeData<QWidget *>(nodeId, NodeRole::Widget);
+}
+
+NodeDataType AbstractGraphModel::portDataType(NodeId nodeId,
+                                              PortType portType,
+                                              PortIndex index) const
+{
+    return portData<NodeDataType>(nodeId, portType, index, PortRole::DataType);
+}
+
+DataTypeHandle AbstractGraphModel::portDataTypeHandle(NodeId nodeId,
+                                                      PortType portType,
+                                                      PortIndex index) const
+{
+    return DataTypeRegistry::instance().intern(portDataType(nodeId, portType, index).id);
+}
+
+bool AbstractGraphModel::portCaptionVisible(NodeId nodeId,
+                                            PortType portType,
+                                            PortIndex index) const
+{
+    return portData<bool>(nodeId, portType, index, PortRole::CaptionVisible);
+}
+
+QString AbstractGraphModel::portCaption(NodeId nodeId, PortType portType, PortIndex index) const
+{
+    return portData<QString>(nodeId, portType, index, PortRole::Caption);
+}
+
+bool AbstractGraphModel::portConnected(NodeId nodeId, PortType portType, PortIndex index) const
+{
+    return !connections(nodeId, portType, index).empty();
+}
+
+QString AbstractGraphModel::portLabel(NodeId nodeId, PortType portType, PortIndex index) const
+{
+    if (portCaptionVisible(nodeId, portType, index))
+        return portCaption(nodeId, portType, index);
+
+    return portDataType(nodeId, portType, index).name;
+}
+
+void AbstractGraphModel::fillRenderInfo(NodeId nodeId, NodeRenderInfo &info) const
+{
+    info.nodeId = nodeId;
+    info.size = nodeSize(nodeId);
+    info.captionVisible = nodeCaptionVisible(nodeId);
+    info.caption = info.captionVisible ? nodeCaption(nodeId) : QString();
+    info.style = &nodeStyle(nodeId);
+
+    for (PortType portType : {PortType::In, PortType::Out}) {
+        std::vector<PortRenderInfo> &ports = info.ports(portType);
+
+        PortCount const n = portCount(nodeId, portType);
+
+        ports.resize(n);
+
+        for (PortIndex portIndex = 0; portIndex < n; ++portIndex) {
+            PortRenderInfo &port = ports[portIndex];
+
+            port.dataType = portDataType(nodeId, portType, portIndex);
+
+            port.typeHandle = portDataTypeHandle(nodeId, portType, portIndex);
+
+            port.label = portCaptionVisible(nodeId, portType, portIndex)
+                             ? portCaption(nodeId, portType, portIndex)
+                             : port.dataType.name;
+
+            port.connected = portConnected(nodeId, portType, portIndex);
+        }
+    }
+}
+
+void AbstractGraphModel::invalidateNodeStyle(NodeId const nodeId) const
+{
+    _nodeStyleCache.erase(nodeId);
+}
+
 void AbstractGraphModel::portsAboutToBeDeleted(NodeId const nodeId,
                                                PortType const portType,
                                                PortIndex const first,
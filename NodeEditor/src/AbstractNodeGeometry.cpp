@@ -5,6 +5,7 @@
 
 #include <QMargins>
 
+#include <algorithm>
 #include <cmath>
 
 namespace QtNodes {
@@ -21,8 +22,11 @@ QRectF AbstractNodeGeometry::boundingRect(NodeId const nodeId) const
 
     double ratio = 0.20;
 
-    int widthMargin = s.width() * ratio;
-    int heightMargin = s.height() * ratio;
+    // Leaves room for the shadow drawn by DefaultNodePainter around small nodes.
+    int const minMargin = 16;
+
+    int widthMargin = std::max<int>(s.width() * ratio, minMargin);
+    int heightMargin = std::max<int>(s.height() * ratio, minMargin);
 
     QMargins margins(widthMargin, heightMargin, widthMargin, heightMargin);
 
@@ -54,10 +58,7 @@ PortIndex AbstractNodeGeometry::checkPortHit(NodeId const nodeId,
 
     double const tolerance = 2.0 * nodeStyle.ConnectionPointDiameter;
 
-    size_t const n = _graphModel.nodeData<unsigned int>(nodeId,
-                                                        (portType == PortType::Out)
-                                                            ? NodeRole::OutPortCount
-                                                            : NodeRole::InPortCount);
+    size_t const n = _graphModel.portCount(nodeId, portType);
 
     for (unsigned int portIndex = 0; portIndex < n; ++portIndex) {
         auto pp = portPosition(nodeId, portType, portIndex);
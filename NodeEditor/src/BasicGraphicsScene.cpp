@@ -2,6 +2,7 @@
 
 #include "AbstractNodeGeometry.hpp"
 #include "ConnectionGraphicsObject.hpp"
+#include "ConnectionLayer.hpp"
 #include "ConnectionIdUtils.hpp"
 #include "DefaultConnectionPainter.hpp"
 #include "DefaultHorizontalNodeGeometry.hpp"
@@ -9,6 +10,7 @@
 #include "DefaultVerticalNodeGeometry.hpp"
 #include "GraphicsView.hpp"
 #include "NodeGraphicsObject.hpp"
+#include "UndoCommands.hpp"
 
 #include <QUndoStack>
 
@@ -24,6 +26,7 @@
 #include <QtCore/QJsonObject>
 #include <QtCore/QtGlobal>
 
+#include <algorithm>
 #include <iostream>
 #include <stdexcept>
 #include <unordered_set>
@@ -35,14 +38,23 @@ namespace QtNodes {
 BasicGraphicsScene::BasicGraphicsScene(AbstractGraphModel &graphModel, QObject *parent)
     : QGraphicsScene(parent)
     , _graphModel(graphModel)
+    , _widgetVirtualization(false)
+    , _lazyCreation(false)
     , _nodeGeometry(std::make_unique<DefaultHorizontalNodeGeometry>(_graphModel))
     , _nodePainter(std::make_unique<DefaultNodePainter>())
     , _connectionPainter(std::make_unique<DefaultConnectionPainter>())
     , _nodeDrag(false)
     , _undoStack(new QUndoStack(this))
+    , _undoMemoryLimit(0)
     , _orientation(Qt::Horizontal)
+    , _reducedDetailScale(0.5)
+    , _minimalDetailScale(0.25)
+    , _viewScale(1.0)
+    , _levelOfDetail(LevelOfDetail::Full)
 {
-    setItemIndexMethod(QGraphicsScene::NoIndex);
+    // The BSP tree serves rubber-band selection, `items(rect)` and the
+    // exposed-rect painting; it is only switched off while nodes are dragged.
+    setItemIndexMethod(QGraphicsScene::BspTreeIndex);
 
     connect(&_graphModel,
             &AbstractGraphModel::connectionCreated,
@@ -74,10 +86,17 @@ BasicGraphicsScene::BasicGraphicsScene(AbstractGraphModel &graphModel, QObject *
             this,
             &BasicGraphicsScene::onNodeUpdated);
 
+    connect(&_graphModel,
+            &AbstractGraphModel::graphChanged,
+            this,
+            &BasicGraphicsScene::onGraphChanged);
+
     connect(this, &BasicGraphicsScene::nodeClicked, this, &BasicGraphicsScene::onNodeClicked);
 
     connect(&_graphModel, &AbstractGraphModel::modelReset, this, &BasicGraphicsScene::onModelReset);
 
+    connect(_undoStack, &QUndoStack::indexChanged, this, &BasicGraphicsScene::enforceUndoMemoryLimit);
+
     traverseGraphAndPopulateGraphicsObjects();
 }
 
@@ -123,6 +142,53 @@ QUndoStack &BasicGraphicsScene::undoStack()
     return *_undoStack;
 }
 
+void BasicGraphicsScene::setUndoMemoryLimit(std::size_t bytes)
+{
+    _undoMemoryLimit = bytes;
+
+    enforceUndoMemoryLimit();
+}
+
+void BasicGraphicsScene::enforceUndoMemoryLimit()
+{
+    if (_undoMemoryLimit == 0)
+        return;
+
+    std::size_t total = 0;
+
+    // Walks from the newest command down, redoable ones included.
+    for (int i = _undoStack->count() - 1; i >= 0; --i) {
+        // QUndoStack only hands out const pointers, the commands are ours though.
+        auto command = const_cast<QUndoCommand *>(_undoStack->command(i));
+        auto diffCommand = dynamic_cast<DiffCommand *>(command);
+
+        if (command->isObsolete())
+            break;
+
+        if (diffCommand)
+            total += diffCommand->diff().memoryCost();
+
+        if (total <= _undoMemoryLimit || i == _undoStack->count() - 1)
+            continue;
+
+        // Undoing anything older would act on a graph missing this change.
+        // Redoable commands are kept, skipping one would break the redo chain.
+        for (int j = std::min(i, _undoStack->index() - 1); j >= 0; --j) {
+            command = const_cast<QUndoCommand *>(_undoStack->command(j));
+
+            if (command->isObsolete())
+                break;
+
+            if (auto expired = dynamic_cast<DiffCommand *>(command))
+                expired->expire();
+            else
+                command->setObsolete(true);
+        }
+
+        break;
+    }
+}
+
 std::unique_ptr<ConnectionGraphicsObject> const &BasicGraphicsScene::makeDraftConnection(
     ConnectionId const incompleteConnectionId)
 {
@@ -140,6 +206,8 @@ void BasicGraphicsScene::resetDraftConnection()
 
 void BasicGraphicsScene::clearScene()
 {
+    ScopedGraphBatch batch(graphModel());
+
     auto const &allNodeIds = graphModel().allNodeIds();
 
     for (auto nodeId : allNodeIds) {
@@ -147,17 +215,157 @@ void BasicGraphicsScene::clearScene()
     }
 }
 
+void BasicGraphicsScene::beginNodeDrag()
+{
+    _drag = NodeDrag();
+    _drag.active = true;
+
+    // Every mouse move would re-insert the dragged nodes and their
+    // connections into the BSP tree; `nodesIn()` and `connectionsIn()` keep
+    // answering from the scene's own indices meanwhile.
+    setItemIndexMethod(QGraphicsScene::NoIndex);
+
+    std::unordered_set<ConnectionId> connections;
+
+    for (QGraphicsItem *item : selectedItems()) {
+        if (auto n = qgraphicsitem_cast<NodeGraphicsObject *>(item)) {
+            _drag.nodes.insert(n->nodeId());
+
+            for (auto const &cid : _graphModel.allConnectionIds(n->nodeId())) {
+                connections.insert(cid);
+            }
+        }
+    }
+
+    _drag.connections.assign(connections.begin(), connections.end());
+}
+
+void BasicGraphicsScene::dragNodes(QPointF const &diff)
+{
+    if (!_drag.active)
+        return;
+
+    _drag.offset += diff;
+
+    // The objects skip `moveConnections()` while the drag is active; their
+    // `itemChange()` still updates the spatial index.
+    for (NodeId const nodeId : _drag.nodes) {
+        if (auto ngo = existingNodeGraphicsObject(nodeId))
+            ngo->moveBy(diff.x(), diff.y());
+    }
+
+    for (ConnectionId const &cid : _drag.connections) {
+        if (auto cgo = connectionGraphicsObject(cid))
+            cgo->move();
+    }
+}
+
+void BasicGraphicsScene::endNodeDrag()
+{
+    if (!_drag.active)
+        return;
+
+    _drag.active = false;
+
+    setItemIndexMethod(QGraphicsScene::BspTreeIndex);
+
+    std::unordered_set<NodeId> nodes;
+
+    for (NodeId const nodeId : _drag.nodes) {
+        if (_graphModel.nodeExists(nodeId))
+            nodes.insert(nodeId);
+    }
+
+    if (!nodes.empty() && !_drag.offset.isNull()) {
+        // `onNodeClicked` reports the move.
+        _nodeDrag = true;
+
+        _undoStack->push(new MoveNodeCommand(this, std::move(nodes), _drag.offset));
+    }
+
+    _drag = NodeDrag();
+}
+
 NodeGraphicsObject *BasicGraphicsScene::nodeGraphicsObject(NodeId nodeId)
 {
-    NodeGraphicsObject *ngo = nullptr;
-    auto it = _nodeGraphicsObjects.find(nodeId);
-    if (it != _nodeGraphicsObjects.end()) {
-        ngo = it->second.get();
+    NodeGraphicsObject *ngo = existingNodeGraphicsObject(nodeId);
+
+    if (!ngo && _deferredNodes.count(nodeId) > 0) {
+        ngo = createNodeGraphicsObject(nodeId, false);
     }
 
     return ngo;
 }
 
+std::vector<NodeGraphicsObject *> BasicGraphicsScene::nodesIn(QRectF const &rect) const
+{
+    std::vector<NodeGraphicsObject *> result;
+
+    _nodeIndex.query(rect, [this, &result](NodeId const nodeId, QRectF const &) {
+        if (auto ngo = existingNodeGraphicsObject(nodeId))
+            result.push_back(ngo);
+    });
+
+    return result;
+}
+
+std::vector<ConnectionGraphicsObject *> BasicGraphicsScene::connectionsIn(QRectF const &rect) const
+{
+    std::vector<ConnectionGraphicsObject *> result;
+
+    _connectionIndex.query(rect, [this, &result](ConnectionId const &cid, QRectF const &) {
+        auto it = _connectionGraphicsObjects.find(cid);
+
+        if (it != _connectionGraphicsObjects.end())
+            result.push_back(it->second.get());
+    });
+
+    return result;
+}
+
+NodeGraphicsObject *BasicGraphicsScene::nodeAt(QPointF const &scenePoint) const
+{
+    NodeGraphicsObject *result = nullptr;
+
+    for (NodeGraphicsObject *ngo : nodesIn(QRectF(scenePoint, QSizeF()))) {
+        if (!ngo->isVisible() || !ngo->contains(ngo->mapFromScene(scenePoint)))
+            continue;
+
+        if (!result) {
+            result = ngo;
+            continue;
+        }
+
+        // The selected node is raised above the others, nodes with equal z
+        // values are stacked in insertion order.
+        if (ngo->zValue() > result->zValue()
+            || (ngo->zValue() == result->zValue()
+                && ngo->insertionOrder() > result->insertionOrder()))
+            result = ngo;
+    }
+
+    return result;
+}
+
+void BasicGraphicsScene::updateSpatialIndex(NodeGraphicsObject const &ngo)
+{
+    _nodeIndex.insert(ngo.nodeId(), ngo.sceneBoundingRect());
+}
+
+void BasicGraphicsScene::updateSpatialIndex(ConnectionGraphicsObject const &cgo)
+{
+    ConnectionId const &cid = cgo.connectionId();
+
+    // The draft connection has a loose end and is not indexed.
+    if (cid.outNodeId == InvalidNodeId || cid.inNodeId == InvalidNodeId)
+        return;
+
+    _connectionIndex.insert(cid, cgo.sceneBoundingRect());
+
+    if (_connectionLayer)
+        _connectionLayer->invalidate(cid);
+}
+
 ConnectionGraphicsObject *BasicGraphicsScene::connectionGraphicsObject(ConnectionId connectionId)
 {
     ConnectionGraphicsObject *cgo = nullptr;
@@ -188,6 +396,148 @@ void BasicGraphicsScene::setOrientation(Qt::Orientation const orientation)
     }
 }
 
+void BasicGraphicsScene::setLazyGraphicsObjectCreation(bool lazy)
+{
+    _lazyCreation = lazy;
+
+    if (!_lazyCreation) {
+        while (!_deferredNodes.empty()) {
+            createNodeGraphicsObject(_deferredNodes.begin()->first, true);
+        }
+
+        while (!_partialNodes.empty()) {
+            createNodeGraphicsObject(*_partialNodes.begin(), true);
+        }
+    }
+}
+
+void BasicGraphicsScene::setBatchedConnectionRendering(bool batched)
+{
+    if (batched == batchedConnectionRendering())
+        return;
+
+    if (batched)
+        _connectionLayer = std::make_unique<ConnectionLayer>(*this);
+    else
+        _connectionLayer.reset();
+
+    for (auto &p : _connectionGraphicsObjects) {
+        p.second->setBatched(batched);
+    }
+}
+
+void BasicGraphicsScene::setVisibleSceneRect(QRectF const &rect)
+{
+    if (rect == _visibleSceneRect)
+        return;
+
+    _visibleSceneRect = rect;
+
+    createVisibleGraphicsObjects();
+
+    updateEmbeddedWidgets();
+}
+
+void BasicGraphicsScene::setWidgetVirtualization(bool enabled)
+{
+    _widgetVirtualization = enabled;
+
+    _embeddedWidgetNodes.clear();
+
+    for (auto &p : _nodeGraphicsObjects) {
+        if (enabled)
+            updateWidgetEmbedding(*p.second);
+        else
+            p.second->setWidgetEmbedded(true);
+    }
+}
+
+void BasicGraphicsScene::updateWidgetEmbedding(NodeGraphicsObject &ngo)
+{
+    if (!_widgetVirtualization)
+        return;
+
+    // Without a view reporting its rect every node counts as visible.
+    bool const embed = (_levelOfDetail == LevelOfDetail::Full)
+                       && (_visibleSceneRect.isEmpty()
+                           || lazyCreationArea().intersects(ngo.sceneBoundingRect()));
+
+    ngo.setWidgetEmbedded(embed);
+
+    if (ngo.widgetEmbedded())
+        _embeddedWidgetNodes.insert(ngo.nodeId());
+    else
+        _embeddedWidgetNodes.erase(ngo.nodeId());
+}
+
+void BasicGraphicsScene::updateEmbeddedWidgets()
+{
+    if (!_widgetVirtualization)
+        return;
+
+    // Detaches the widgets which went out of range...
+    std::vector<NodeId> const embedded(_embeddedWidgetNodes.begin(), _embeddedWidgetNodes.end());
+
+    for (NodeId const nodeId : embedded) {
+        if (auto ngo = existingNodeGraphicsObject(nodeId))
+            updateWidgetEmbedding(*ngo);
+        else
+            _embeddedWidgetNodes.erase(nodeId);
+    }
+
+    if (_levelOfDetail != LevelOfDetail::Full || _visibleSceneRect.isEmpty())
+        return;
+
+    // ...and embeds the ones which came close.
+    for (NodeId const nodeId : _nodeIndex.query(lazyCreationArea())) {
+        if (_embeddedWidgetNodes.count(nodeId) > 0)
+            continue;
+
+        if (auto ngo = existingNodeGraphicsObject(nodeId))
+            updateWidgetEmbedding(*ngo);
+    }
+}
+
+void BasicGraphicsScene::setLevelOfDetailScales(double reduced, double minimal)
+{
+    _reducedDetailScale = reduced;
+    _minimalDetailScale = minimal;
+
+    // The painters pick the new thresholds up on the next repaint.
+    setViewScale(_viewScale);
+
+    update();
+}
+
+LevelOfDetail BasicGraphicsScene::levelOfDetail(double scale) const
+{
+    if (scale < _minimalDetailScale)
+        return LevelOfDetail::Minimal;
+
+    if (scale < _reducedDetailScale)
+        return LevelOfDetail::Reduced;
+
+    return LevelOfDetail::Full;
+}
+
+void BasicGraphicsScene::setViewScale(double scale)
+{
+    _viewScale = scale;
+
+    LevelOfDetail const lod = levelOfDetail(scale);
+
+    if (lod == _levelOfDetail)
+        return;
+
+    _levelOfDetail = lod;
+
+    for (auto &p : _nodeGraphicsObjects) {
+        p.second->updateLevelOfDetail();
+    }
+
+    updateEmbeddedWidgets();
+}
+
 QMenu *BasicGraphicsScene::createSceneMenu(QPointF const scenePos)
 {
     Q_UNUSED(scenePos);
@@ -198,6 +548,22 @@ void BasicGraphicsScene::traverseGraphAndPopulateGraphicsObjects()
 {
     auto allNodeIds = _graphModel.allNodeIds();
 
+    if (_lazyCreation) {
+        for (NodeId const nodeId : allNodeIds) {
+            QPointF const pos = _graphModel.nodeData(nodeId, NodeRole::Position).value<QPointF>();
+
+            _deferredNodes[nodeId] = pos;
+            _deferredNodeIndex.insert(nodeId, QRectF(pos, QSizeF()));
+
+            for (auto const &cid : _graphModel.allConnectionIds(nodeId)) {
+                _deferredConnections.insert(cid);
+            }
+        }
+
+        createVisibleGraphicsObjects();
+        return;
+    }
+
     // First create all the nodes.
     for (NodeId const nodeId : allNodeIds) {
         _nodeGraphicsObjects[nodeId] = std::make_unique<NodeGraphicsObject>(*this, nodeId);
@@ -205,14 +571,13 @@ void BasicGraphicsScene::traverseGraphAndPopulateGraphicsObjects()
 
     // Then for each node check output connections and insert them.
     for (NodeId const nodeId : allNodeIds) {
-        auto nOutPorts = _graphModel.nodeData<PortCount>(nodeId, NodeRole::OutPortCount);
+        auto nOutPorts = _graphModel.portCount(nodeId, PortType::Out);
 
         for (PortIndex index = 0; index < nOutPorts; ++index) {
             auto const &outConnectionIds = _graphModel.connections(nodeId, PortType::Out, index);
 
             for (auto cid : outConnectionIds) {
-                _connectionGraphicsObjects[cid] = std::make_unique<ConnectionGraphicsObject>(*this,
-                                                                                             cid);
+                createConnectionGraphicsObject(cid);
             }
         }
     }
@@ -221,15 +586,170 @@ void BasicGraphicsScene::traverseGraphAndPopulateGraphicsObjects()
 void BasicGraphicsScene::updateAttachedNodes(ConnectionId const connectionId,
                                              PortType const portType)
 {
-    auto node = nodeGraphicsObject(getNodeId(portType, connectionId));
+    auto node = existingNodeGraphicsObject(getNodeId(portType, connectionId));
+
+    if (node) {
+        node->update();
+    }
+}
+
+NodeGraphicsObject *BasicGraphicsScene::existingNodeGraphicsObject(NodeId const nodeId) const
+{
+    auto it = _nodeGraphicsObjects.find(nodeId);
+    if (it != _nodeGraphicsObjects.end()) {
+        return it->second.get();
+    }
+
+    return nullptr;
+}
+
+NodeGraphicsObject *BasicGraphicsScene::createNodeGraphicsObject(NodeId const nodeId,
+                                                                 bool withNeighbours)
+{
+    _deferredNodes.erase(nodeId);
+    _deferredNodeIndex.remove(nodeId);
+
+    auto &ngo = _nodeGraphicsObjects[nodeId];
+    if (!ngo)
+        ngo = std::make_unique<NodeGraphicsObject>(*this, nodeId);
+
+    bool complete = true;
+
+    for (auto const &cid : _graphModel.allConnectionIds(nodeId)) {
+        if (_deferredConnections.count(cid) == 0)
+            continue;
+
+        NodeId const otherNodeId = (cid.outNodeId == nodeId) ? cid.inNodeId : cid.outNodeId;
+
+        // Creating the neighbour also creates this connection.
+        if (withNeighbours && _deferredNodes.count(otherNodeId) > 0) {
+            createNodeGraphicsObject(otherNodeId, false);
+        } else if (existingNodeGraphicsObject(otherNodeId)) {
+            createConnectionGraphicsObject(cid);
+        } else {
+            complete = false;
+        }
+    }
+
+    if (complete)
+        _partialNodes.erase(nodeId);
+    else
+        _partialNodes.insert(nodeId);
+
+    return ngo.get();
+}
+
+void BasicGraphicsScene::createConnectionGraphicsObject(ConnectionId const connectionId)
+{
+    _deferredConnections.erase(connectionId);
+
+    auto &cgo = _connectionGraphicsObjects[connectionId];
+
+    cgo = std::make_unique<ConnectionGraphicsObject>(*this, connectionId);
+
+    if (_connectionLayer)
+        cgo->setBatched(true);
+}
+
+QRectF BasicGraphicsScene::lazyCreationArea() const
+{
+    // Half a screen around the view, scrolling a bit does not reveal empty space.
+    qreal const dx = _visibleSceneRect.width() / 2;
+    qreal const dy = _visibleSceneRect.height() / 2;
+
+    return _visibleSceneRect.adjusted(-dx, -dy, dx, dy);
+}
+
+void BasicGraphicsScene::createVisibleGraphicsObjects()
+{
+    if ((_deferredNodes.empty() && _partialNodes.empty()) || _visibleSceneRect.isEmpty())
+        return;
+
+    QRectF const area = lazyCreationArea();
+
+    std::vector<NodeId> visibleNodes = _deferredNodeIndex.query(area);
+
+    for (NodeId const nodeId : _partialNodes) {
+        if (area.contains(_nodeGraphicsObjects[nodeId]->pos()))
+            visibleNodes.push_back(nodeId);
+    }
+
+    for (NodeId const nodeId : visibleNodes) {
+        // Could have been completed as a neighbour of an earlier node.
+        if (_deferredNodes.count(nodeId) > 0 || _partialNodes.count(nodeId) > 0)
+            createNodeGraphicsObject(nodeId, true);
+    }
+}
+
+void BasicGraphicsScene::placeNodeGraphicsObject(NodeId const nodeId)
+{
+    if (_lazyCreation) {
+        QPointF const pos = _graphModel.nodeData(nodeId, NodeRole::Position).value<QPointF>();
+
+        if (lazyCreationArea().contains(pos)) {
+            createNodeGraphicsObject(nodeId, true);
+        } else {
+            // Most models assign the position right after the creation,
+            // `onNodePositionUpdated` takes care of that.
+            _deferredNodes[nodeId] = pos;
+            _deferredNodeIndex.insert(nodeId, QRectF(pos, QSizeF()));
+        }
+    } else {
+        _nodeGraphicsObjects[nodeId] = std::make_unique<NodeGraphicsObject>(*this, nodeId);
+    }
+}
+
+void BasicGraphicsScene::placeConnectionGraphicsObject(ConnectionId const connectionId)
+{
+    bool const outExists = existingNodeGraphicsObject(connectionId.outNodeId) != nullptr;
+    bool const inExists = existingNodeGraphicsObject(connectionId.inNodeId) != nullptr;
+
+    if (outExists || inExists) {
+        // A node with a graphics object shows all of its connections.
+        nodeGraphicsObject(connectionId.outNodeId);
+        nodeGraphicsObject(connectionId.inNodeId);
+
+        createConnectionGraphicsObject(connectionId);
+    } else {
+        _deferredConnections.insert(connectionId);
+    }
+}
+
+bool BasicGraphicsScene::moveNodeGraphicsObject(NodeId const nodeId)
+{
+    auto deferred = _deferredNodes.find(nodeId);
+    if (deferred != _deferredNodes.end()) {
+        deferred->second = _graphModel.nodeData(nodeId, NodeRole::Position).value<QPointF>();
+        _deferredNodeIndex.insert(nodeId, QRectF(deferred->second, QSizeF()));
 
+        if (lazyCreationArea().contains(deferred->second))
+            createNodeGraphicsObject(nodeId, true);
+
+        return false;
+    }
+
+    auto node = existingNodeGraphicsObject(nodeId);
     if (node) {
+        node->setPos(_graphModel.nodeData(nodeId, NodeRole::Position).value<QPointF>());
         node->update();
+
+        updateSpatialIndex(*node);
+        return true;
     }
+
+    return false;
 }
 
 void BasicGraphicsScene::onConnectionDeleted(ConnectionId const connectionId)
 {
+    // Deletions are applied right away even within a batch, so that no
+    // graphics object outlives its model counterpart.
+    _connectionIndex.remove(connectionId);
+    _deferredConnections.erase(connectionId);
+
+    if (_connectionLayer)
+        _connectionLayer->invalidate(connectionId);
+
     auto it = _connectionGraphicsObjects.find(connectionId);
     if (it != _connectionGraphicsObjects.end()) {
         _connectionGraphicsObjects.erase(it);
@@ -240,6 +760,9 @@ void BasicGraphicsScene::onConnectionDeleted(ConnectionId const connectionId)
         _draftConnection.reset();
     }
 
+    if (_graphModel.inBatch())
+        return;
+
     updateAttachedNodes(connectionId, PortType::Out);
     updateAttachedNodes(connectionId, PortType::In);
 
@@ -248,8 +771,11 @@ void BasicGraphicsScene::onConnectionDeleted(ConnectionId const connectionId)
 
 void BasicGraphicsScene::onConnectionCreated(ConnectionId const connectionId)
 {
-    _connectionGraphicsObjects[connectionId]
-        = std::make_unique<ConnectionGraphicsObject>(*this, connectionId);
+    // Handled by `onGraphChanged`.
+    if (_graphModel.inBatch())
+        return;
+
+    placeConnectionGraphicsObject(connectionId);
 
     updateAttachedNodes(connectionId, PortType::Out);
     updateAttachedNodes(connectionId, PortType::In);
@@ -259,46 +785,95 @@ void BasicGraphicsScene::onConnectionCreated(ConnectionId const connectionId)
 
 void BasicGraphicsScene::onNodeDeleted(NodeId const nodeId)
 {
+    _nodeIndex.remove(nodeId);
+    _deferredNodeIndex.remove(nodeId);
+    _deferredNodes.erase(nodeId);
+    _partialNodes.erase(nodeId);
+    _embeddedWidgetNodes.erase(nodeId);
+
+    _nodeGeometry->invalidateLayout(nodeId);
+
     auto it = _nodeGraphicsObjects.find(nodeId);
     if (it != _nodeGraphicsObjects.end()) {
         _nodeGraphicsObjects.erase(it);
 
-        Q_EMIT modified(this);
+        if (!_graphModel.inBatch())
+            Q_EMIT modified(this);
     }
 }
 
 void BasicGraphicsScene::onNodeCreated(NodeId const nodeId)
 {
-    _nodeGraphicsObjects[nodeId] = std::make_unique<NodeGraphicsObject>(*this, nodeId);
+    if (_graphModel.inBatch())
+        return;
+
+    placeNodeGraphicsObject(nodeId);
 
     Q_EMIT modified(this);
 }
 
 void BasicGraphicsScene::onNodePositionUpdated(NodeId const nodeId)
 {
-    auto node = nodeGraphicsObject(nodeId);
-    if (node) {
-        node->setPos(_graphModel.nodeData(nodeId, NodeRole::Position).value<QPointF>());
-        node->update();
+    if (_graphModel.inBatch())
+        return;
+
+    if (moveNodeGraphicsObject(nodeId))
         _nodeDrag = true;
-    }
 }
 
 void BasicGraphicsScene::onNodeUpdated(NodeId const nodeId)
 {
-    auto node = nodeGraphicsObject(nodeId);
+    if (_graphModel.inBatch())
+        return;
+
+    auto node = existingNodeGraphicsObject(nodeId);
 
     if (node) {
         node->setGeometryChanged();
 
         _nodeGeometry->recomputeSize(nodeId);
 
+        updateSpatialIndex(*node);
+
         node->updateQWidgetEmbedPos();
         node->update();
         node->moveConnections();
     }
 }
 
+void BasicGraphicsScene::onGraphChanged(GraphChanges const &changes)
+{
+    // Deleted objects are already gone, see `onNodeDeleted`.
+
+    for (NodeId const nodeId : changes.createdNodes) {
+        placeNodeGraphicsObject(nodeId);
+    }
+
+    for (ConnectionId const &connectionId : changes.createdConnections) {
+        placeConnectionGraphicsObject(connectionId);
+    }
+
+    for (NodeId const nodeId : changes.movedNodes) {
+        moveNodeGraphicsObject(nodeId);
+    }
+
+    for (NodeId const nodeId : changes.updatedNodes) {
+        onNodeUpdated(nodeId);
+    }
+
+    for (ConnectionId const &connectionId : changes.createdConnections) {
+        updateAttachedNodes(connectionId, PortType::Out);
+        updateAttachedNodes(connectionId, PortType::In);
+    }
+
+    for (ConnectionId const &connectionId : changes.deletedConnections) {
+        updateAttachedNodes(connectionId, PortType::Out);
+        updateAttachedNodes(connectionId, PortType::In);
+    }
+
+    Q_EMIT modified(this);
+}
+
 void BasicGraphicsScene::onNodeClicked(NodeId const nodeId)
 {
     if (_nodeDrag) {
@@ -312,9 +887,25 @@ void BasicGraphicsScene::onModelReset()
 {
     _connectionGraphicsObjects.clear();
     _nodeGraphicsObjects.clear();
+    _deferredConnections.clear();
+    _deferredNodes.clear();
+    _partialNodes.clear();
+    _embeddedWidgetNodes.clear();
+    _deferredNodeIndex.clear();
+    _nodeIndex.clear();
+    _connectionIndex.clear();
+
+    // `clear()` would delete the layer, which the scene owns.
+    if (_connectionLayer) {
+        _connectionLayer->clear();
+        removeItem(_connectionLayer.get());
+    }
 
     clear();
 
+    if (_connectionLayer)
+        addItem(_connectionLayer.get());
+
     traverseGraphAndPopulateGraphicsObjects();
 }
 
@@ -20,8 +20,6 @@
 
 #include <QtCore/QDebug>
 
-#include <stdexcept>
-
 namespace QtNodes {
 
 ConnectionGraphicsObject::ConnectionGraphicsObject(BasicGraphicsScene &scene,
@@ -31,6 +29,9 @@ ConnectionGraphicsObject::ConnectionGraphicsObject(BasicGraphicsScene &scene,
     , _connectionState(*this)
     , _out{0, 0}
     , _in{0, 0}
+    , _geometryDirty(true)
+    , _shapeDirty(true)
+    , _batched(false)
 {
     scene.addItem(this);
 
@@ -98,12 +99,32 @@ ConnectionId const &ConnectionGraphicsObject::connectionId() const
 
 QRectF ConnectionGraphicsObject::boundingRect() const
 {
-    auto points = pointsC1C2();
+    updateGeometry();
+
+    return _boundingRect;
+}
+
+void ConnectionGraphicsObject::updateGeometry() const
+{
+    if (!_geometryDirty)
+        return;
+
+    _geometryDirty = false;
+
+    switch (nodeScene()->orientation()) {
+    case Qt::Horizontal:
+        _c1c2 = pointsC1C2Horizontal();
+        break;
+
+    case Qt::Vertical:
+        _c1c2 = pointsC1C2Vertical();
+        break;
+    }
 
     // `normalized()` fixes inverted rects.
     QRectF basicRect = QRectF(_out, _in).normalized();
 
-    QRectF c1c2Rect = QRectF(points.first, points.second).normalized();
+    QRectF c1c2Rect = QRectF(_c1c2.first, _c1c2.second).normalized();
 
     QRectF commonRect = basicRect.united(c1c2Rect);
 
@@ -115,7 +136,7 @@ QRectF ConnectionGraphicsObject::boundingRect() const
     commonRect.setTopLeft(commonRect.topLeft() - cornerOffset);
     commonRect.setBottomRight(commonRect.bottomRight() + 2 * cornerOffset);
 
-    return commonRect;
+    _boundingRect = commonRect;
 }
 
 QPainterPath ConnectionGraphicsObject::shape() const
@@ -128,7 +149,12 @@ QPainterPath ConnectionGraphicsObject::shape() const
     //return path;
 
 #else
-    return nodeScene()->connectionPainter().getPainterStroke(*this);
+    if (_shapeDirty) {
+        _shape = nodeScene()->connectionPainter().getPainterStroke(*this);
+        _shapeDirty = false;
+    }
+
+    return _shape;
 #endif
 }
 
@@ -145,10 +171,16 @@ void ConnectionGraphicsObject::setEndPoint(PortType portType, QPointF const &poi
         _in = point;
     else
         _out = point;
+
+    _geometryDirty = true;
+    _shapeDirty = true;
 }
 
 void ConnectionGraphicsObject::move()
 {
+    // Reports the cached rect as the old geometry, before the ends change.
+    prepareGeometryChange();
+
     auto moveEnd = [this](ConnectionId cId, PortType portType) {
         NodeId nodeId = getNodeId(portType, cId);
 
@@ -174,9 +206,9 @@ void ConnectionGraphicsObject::move()
     moveEnd(_connectionId, PortType::Out);
     moveEnd(_connectionId, PortType::In);
 
-    prepareGeometryChange();
-
     update();
+
+    nodeScene()->updateSpatialIndex(*this);
 }
 
 ConnectionState const &ConnectionGraphicsObject::connectionState() const
@@ -189,6 +221,16 @@ ConnectionState &ConnectionGraphicsObject::connectionState()
     return _connectionState;
 }
 
+void ConnectionGraphicsObject::setBatched(bool batched)
+{
+    _batched = batched;
+
+    setAcceptHoverEvents(!batched);
+    setAcceptedMouseButtons(batched ? Qt::NoButton : Qt::AllButtons);
+
+    update();
+}
+
 void ConnectionGraphicsObject::paint(QPainter *painter,
                                      QStyleOptionGraphicsItem const *option,
                                      QWidget *)
@@ -196,6 +238,9 @@ void ConnectionGraphicsObject::paint(QPainter *painter,
     if (!scene())
         return;
 
+    if (_batched && !isSelected() && !_connectionState.hovered())
+        return;
+
     painter->setClipRect(option->exposedRect);
 
     nodeScene()->connectionPainter().paint(painter, *this);
@@ -289,17 +334,9 @@ void ConnectionGraphicsObject::hoverLeaveEvent(QGraphicsSceneHoverEvent *event)
 
 std::pair<QPointF, QPointF> ConnectionGraphicsObject::pointsC1C2() const
 {
-    switch (nodeScene()->orientation()) {
-    case Qt::Horizontal:
-        return pointsC1C2Horizontal();
-        break;
-
-    case Qt::Vertical:
-        return pointsC1C2Vertical();
-        break;
-    }
+    updateGeometry();
 
-    throw std::logic_error("Unreachable code after switch statement");
+    return _c1c2;
 }
 
 void ConnectionGraphicsObject::addGraphicsEffect()
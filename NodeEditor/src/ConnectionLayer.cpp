@@ -0,0 +1,355 @@
+#include "ConnectionLayer.hpp"
+
+#include "AbstractGraphModel.hpp"
+#include "BasicGraphicsScene.hpp"
+#include "ConnectionGraphicsObject.hpp"
+#include "ConnectionState.hpp"
+#include "StyleCollection.hpp"
+
+#include <QtGui/QPainter>
+#include <QtGui/QPainterPathStroker>
+#include <QtWidgets/QGraphicsSceneHoverEvent>
+#include <QtWidgets/QGraphicsSceneMouseEvent>
+#include <QtWidgets/QStyleOptionGraphicsItem>
+
+#include <algorithm>
+
+namespace QtNodes {
+
+namespace {
+
+/// Line segments per flattened connection.
+constexpr int CurveSegments = 24;
+
+/// Same as the default tolerance of `connectionAt()`.
+constexpr qreal HitTolerance = 5.0;
+
+qreal squaredDistance(QPointF const &p, QLineF const &line)
+{
+    QPointF const d = line.p2() - line.p1();
+
+    qreal const length = QPointF::dotProduct(d, d);
+
+    qreal t = 0.0;
+
+    if (length > 0.0)
+        t = std::max<qreal>(0.0, std::min<qreal>(1.0, QPointF::dotProduct(p - line.p1(), d) / length));
+
+    QPointF const diff = p - (line.p1() + t * d);
+
+    return QPointF::dotProduct(diff, diff);
+}
+
+/// Liang-Barsky clipping, true when any part of `line` lies inside `rect`.
+bool intersects(QLineF const &line, QRectF const &rect)
+{
+    QPointF const d = line.p2() - line.p1();
+
+    qreal const p[4] = {-d.x(), d.x(), -d.y(), d.y()};
+    qreal const q[4] = {line.x1() - rect.left(),
+                        rect.right() - line.x1(),
+                        line.y1() - rect.top(),
+                        rect.bottom() - line.y1()};
+
+    qreal t0 = 0.0;
+    qreal t1 = 1.0;
+
+    for (int i = 0; i < 4; ++i) {
+        if (p[i] == 0.0) {
+            if (q[i] < 0.0)
+                return false;
+            continue;
+        }
+
+        qreal const t = q[i] / p[i];
+
+        if (p[i] < 0.0)
+            t0 = std::max(t0, t);
+        else
+            t1 = std::min(t1, t);
+
+        if (t0 > t1)
+            return false;
+    }
+
+    return true;
+}
+
+} // namespace
+
+ConnectionLayer::ConnectionLayer(BasicGraphicsScene &scene)
+    : _scene(scene)
+    , _hasShape(false)
+    , _hasHovered(false)
+    , _hovered{InvalidNodeId, InvalidPortIndex, InvalidNodeId, InvalidPortIndex}
+{
+    scene.addItem(this);
+
+    // `paint()` only visits the connections overlapping `exposedRect`.
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption, true);
+
+    setAcceptHoverEvents(true);
+
+    // Below the connection objects, which are at -1.
+    setZValue(-2.0);
+}
+
+QRectF ConnectionLayer::boundingRect() const
+{
+    // Same extent as the scene rect set up by GraphicsView.
+    int const maxSize = 32767;
+
+    return QRectF(-maxSize, -maxSize, maxSize * 2, maxSize * 2);
+}
+
+bool ConnectionLayer::contains(QPointF const &point) const
+{
+    return connectionAt(point) != nullptr;
+}
+
+QPainterPath ConnectionLayer::shape() const
+{
+    if (_hasShape)
+        return _shape;
+
+    QPainterPath curves;
+
+    for (ConnectionGraphicsObject *cgo : _scene.connectionsIn(boundingRect())) {
+        curves.addPolygon(curve(*cgo).points);
+    }
+
+    QPainterPathStroker stroker;
+    stroker.setWidth(2 * HitTolerance);
+
+    _shape = stroker.createStroke(curves);
+    _hasShape = true;
+
+    return _shape;
+}
+
+bool ConnectionLayer::collidesWithPath(QPainterPath const &path, Qt::ItemSelectionMode mode) const
+{
+    if (mode == Qt::IntersectsItemBoundingRect || mode == Qt::ContainsItemBoundingRect)
+        return QGraphicsItem::collidesWithPath(path, mode);
+
+    // The curves span the whole scene, no selection area contains them.
+    if (mode == Qt::ContainsItemShape)
+        return false;
+
+    // The layer sits at the origin, item and scene coordinates are the same.
+    QRectF const area = path.boundingRect().adjusted(-HitTolerance,
+                                                     -HitTolerance,
+                                                     HitTolerance,
+                                                     HitTolerance);
+
+    for (ConnectionGraphicsObject *cgo : _scene.connectionsIn(area)) {
+        QPolygonF const &points = curve(*cgo).points;
+
+        for (int i = 1; i < points.size(); ++i) {
+            if (intersects(QLineF(points[i - 1], points[i]), area))
+                return true;
+        }
+    }
+
+    return false;
+}
+
+void ConnectionLayer::invalidate(ConnectionId const &connectionId)
+{
+    _curves.erase(connectionId);
+
+    _hasShape = false;
+}
+
+void ConnectionLayer::clear()
+{
+    _curves.clear();
+
+    _shape = QPainterPath();
+    _hasShape = false;
+
+    _hasHovered = false;
+}
+
+ConnectionGraphicsObject *ConnectionLayer::connectionAt(QPointF const &scenePoint,
+                                                        qreal tolerance) const
+{
+    QRectF const area(scenePoint - QPointF(tolerance, tolerance),
+                      QSizeF(2 * tolerance, 2 * tolerance));
+
+    ConnectionGraphicsObject *result = nullptr;
+
+    qreal best = tolerance * tolerance;
+
+    for (ConnectionGraphicsObject *cgo : _scene.connectionsIn(area)) {
+        QPolygonF const &points = curve(*cgo).points;
+
+        for (int i = 1; i < points.size(); ++i) {
+            qreal const d = squaredDistance(scenePoint, QLineF(points[i - 1], points[i]));
+
+            if (d <= best) {
+                best = d;
+                result = cgo;
+            }
+        }
+    }
+
+    return result;
+}
+
+void ConnectionLayer::paint(QPainter *painter, QStyleOptionGraphicsItem const *option, QWidget *)
+{
+    qreal const scale = QStyleOptionGraphicsItem::levelOfDetailFromTransform(
+        painter->worldTransform());
+
+    bool const straight = (_scene.levelOfDetail(scale) == LevelOfDetail::Minimal);
+
+    for (auto &lines : _lines) {
+        lines.clear();
+    }
+
+    for (ConnectionGraphicsObject *cgo : _scene.connectionsIn(option->exposedRect)) {
+        // These draw their own highlight on top.
+        if (cgo->isSelected() || cgo->connectionState().hovered())
+            continue;
+
+        Curve const &c = curve(*cgo);
+
+        QVector<QLineF> &lines = _lines[c.color.rgba()];
+
+        if (straight) {
+            lines.push_back(QLineF(c.points.first(), c.points.last()));
+            continue;
+        }
+
+        for (int i = 1; i < c.points.size(); ++i) {
+            lines.push_back(QLineF(c.points[i - 1], c.points[i]));
+        }
+    }
+
+    auto const &connectionStyle = StyleCollection::connectionStyle();
+
+    QPen pen;
+    pen.setWidthF(connectionStyle.lineWidth());
+    pen.setCapStyle(Qt::RoundCap);
+
+    painter->setBrush(Qt::NoBrush);
+
+    if (straight)
+        painter->setRenderHint(QPainter::Antialiasing, false);
+
+    for (auto it = _lines.cbegin(); it != _lines.cend(); ++it) {
+        if (it.value().isEmpty())
+            continue;
+
+        pen.setColor(QColor::fromRgba(it.key()));
+
+        painter->setPen(pen);
+        painter->drawLines(it.value());
+    }
+}
+
+void ConnectionLayer::hoverEnterEvent(QGraphicsSceneHoverEvent *event)
+{
+    setHovered(connectionAt(event->scenePos()), event->screenPos());
+}
+
+void ConnectionLayer::hoverMoveEvent(QGraphicsSceneHoverEvent *event)
+{
+    setHovered(connectionAt(event->scenePos()), event->screenPos());
+}
+
+void ConnectionLayer::hoverLeaveEvent(QGraphicsSceneHoverEvent *event)
+{
+    setHovered(nullptr, event->screenPos());
+}
+
+void ConnectionLayer::mousePressEvent(QGraphicsSceneMouseEvent *event)
+{
+    ConnectionGraphicsObject *cgo = connectionAt(event->scenePos());
+
+    if (!cgo) {
+        event->ignore();
+        return;
+    }
+
+    // Same as the default selection handling of a selectable item.
+    if (event->modifiers() & Qt::ControlModifier) {
+        cgo->setSelected(!cgo->isSelected());
+    } else {
+        _scene.clearSelection();
+        cgo->setSelected(true);
+    }
+
+    event->accept();
+}
+
+ConnectionLayer::Curve const &ConnectionLayer::curve(ConnectionGraphicsObject const &cgo) const
+{
+    auto it = _curves.find(cgo.connectionId());
+
+    if (it != _curves.end())
+        return it->second;
+
+    Curve c;
+
+    auto const c1c2 = cgo.pointsC1C2();
+
+    QPointF const p0 = cgo.mapToScene(cgo.out());
+    QPointF const p1 = cgo.mapToScene(c1c2.first);
+    QPointF const p2 = cgo.mapToScene(c1c2.second);
+    QPointF const p3 = cgo.mapToScene(cgo.in());
+
+    c.points.reserve(CurveSegments + 1);
+
+    for (int i = 0; i <= CurveSegments; ++i) {
+        qreal const t = qreal(i) / CurveSegments;
+        qreal const u = 1.0 - t;
+
+        c.points.push_back(u * u * u * p0 + 3 * u * u * t * p1 + 3 * u * t * t * p2
+                           + t * t * t * p3);
+    }
+
+    auto const &connectionStyle = StyleCollection::connectionStyle();
+
+    c.color = connectionStyle.normalColor();
+
+    // Connections between different types get the output color only.
+    if (connectionStyle.useDataDefinedColors()) {
+        ConnectionId const &cId = cgo.connectionId();
+
+        c.color = connectionStyle.normalColor(
+            cgo.graphModel().portDataTypeHandle(cId.outNodeId, PortType::Out, cId.outPortIndex));
+    }
+
+    return _curves.emplace(cgo.connectionId(), std::move(c)).first->second;
+}
+
+void ConnectionLayer::setHovered(ConnectionGraphicsObject *cgo, QPoint const &screenPos)
+{
+    ConnectionGraphicsObject *previous = _hasHovered ? _scene.connectionGraphicsObject(_hovered)
+                                                     : nullptr;
+
+    if (cgo == previous)
+        return;
+
+    if (previous) {
+        previous->connectionState().setHovered(false);
+        previous->update();
+
+        Q_EMIT _scene.connectionHoverLeft(_hovered);
+    }
+
+    _hasHovered = (cgo != nullptr);
+
+    if (cgo) {
+        _hovered = cgo->connectionId();
+
+        cgo->connectionState().setHovered(true);
+        cgo->update();
+
+        Q_EMIT _scene.connectionHovered(_hovered, screenPos);
+    }
+}
+
+} // namespace QtNodes
@@ -8,8 +8,6 @@
 
 #include <QDebug>
 
-#include <random>
-
 using QtNodes::ConnectionStyle;
 
 inline void initResources()
@@ -156,17 +154,12 @@ QColor ConnectionStyle::normalColor() const
 
 QColor ConnectionStyle::normalColor(QString typeId) const
 {
-    std::size_t hash = qHash(typeId);
-
-    std::size_t const hue_range = 0xFF;
-
-    std::mt19937 gen(static_cast<unsigned int>(hash));
-    std::uniform_int_distribution<int> distrib(0, hue_range);
-
-    int hue = distrib(gen);
-    int sat = 120 + hash % 129;
+    return normalColor(QtNodes::DataTypeRegistry::instance().intern(typeId));
+}
 
-    return QColor::fromHsl(hue, sat, 160);
+QColor ConnectionStyle::normalColor(QtNodes::DataTypeHandle typeHandle) const
+{
+    return QtNodes::DataTypeRegistry::instance().color(typeHandle);
 }
 
 QColor ConnectionStyle::selectedColor() const
@@ -0,0 +1,411 @@
+#include "DataFlowExecutor.hpp"
+
+#include "DataFlowGraphModel.hpp"
+#include "NodeDelegateModel.hpp"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDebug>
+#include <QtCore/QRunnable>
+
+#include <algorithm>
+#include <functional>
+
+namespace QtNodes {
+
+namespace {
+
+class ComputeTask : public QRunnable
+{
+public:
+    explicit ComputeTask(std::function<void()> function)
+        : _function(std::move(function))
+    {}
+
+    void run() override { _function(); }
+
+private:
+    std::function<void()> _function;
+};
+
+} // namespace
+
+DataFlowExecutor::DataFlowExecutor(DataFlowGraphModel &model)
+    : _model(model)
+    , _threaded(true)
+    , _waveActive(false)
+    , _processing(false)
+    , _evaluatingNode(InvalidNodeId)
+{
+    //
+}
+
+DataFlowExecutor::~DataFlowExecutor()
+{
+    // Queued results addressed to `this` are dropped by Qt once the object is gone.
+    _threadPool.waitForDone();
+}
+
+void DataFlowExecutor::finish()
+{
+    if (_processing || _evaluatingNode != InvalidNodeId)
+        return;
+
+    while (_waveActive || !_dirtyPorts.empty()) {
+        if (!_waveActive) {
+            startWave();
+            continue;
+        }
+
+        // Nothing left that could complete the wave.
+        if (_running.empty())
+            break;
+
+        _threadPool.waitForDone();
+
+        // The tasks queue their results on `this`.
+        QCoreApplication::sendPostedEvents(this, QEvent::MetaCall);
+    }
+}
+
+void DataFlowExecutor::outPortDataUpdated(NodeId const nodeId, PortIndex const portIndex)
+{
+    // The node is being evaluated by the executor itself, propagation is
+    // handled in `finishNode`.
+    if (nodeId == _evaluatingNode) {
+        _emittedPorts.insert(portIndex);
+        return;
+    }
+
+    for (auto const &cn : _model.connections(nodeId, PortType::Out, portIndex)) {
+        _dirtyPorts[cn.inNodeId].insert(cn.inPortIndex);
+    }
+
+    if (!_waveActive)
+        startWave();
+}
+
+void DataFlowExecutor::inPortDataChanged(NodeId const nodeId, PortIndex const portIndex)
+{
+    _dirtyPorts[nodeId].insert(portIndex);
+
+    if (!_waveActive)
+        startWave();
+}
+
+void DataFlowExecutor::connectionDeleted(ConnectionId const connectionId)
+{
+    if (!_waveActive)
+        return;
+
+    // The connection no longer releases its target. Connections made
+    // during the wave, or whose source already finished, were not counted.
+    if (_countedConnections.erase(connectionId) == 0)
+        return;
+
+    auto it = _pendingPredecessors.find(connectionId.inNodeId);
+    if (it != _pendingPredecessors.end() && it->second > 0 && --it->second == 0) {
+        _ready.push_back(connectionId.inNodeId);
+
+        processReadyNodes();
+    }
+}
+
+void DataFlowExecutor::nodeDeleted(NodeId const nodeId, std::unique_ptr<NodeDelegateModel> delegate)
+{
+    _dirtyPorts.erase(nodeId);
+
+    if (!_waveActive)
+        return;
+
+    if (_running.erase(nodeId) > 0 && delegate) {
+        // `compute()` of the node may still be reading the delegate model.
+        QObject::disconnect(delegate.get(), nullptr, nullptr, nullptr);
+
+        NodeDelegateModel const *key = delegate.get();
+
+        _detached.emplace(key, std::move(delegate));
+    }
+
+    _waveDirtyPorts.erase(nodeId);
+    _unfinished.erase(nodeId);
+    _pendingPredecessors.erase(nodeId);
+    _pathCounts.erase(nodeId);
+    _ready.erase(std::remove(_ready.begin(), _ready.end(), nodeId), _ready.end());
+
+    finishWaveIfIdle();
+}
+
+void DataFlowExecutor::startWave()
+{
+    if (_dirtyPorts.empty())
+        return;
+
+    _waveActive = true;
+
+    _waveDirtyPorts.swap(_dirtyPorts);
+    _dirtyPorts.clear();
+
+    // Collects the dirty nodes and everything downstream of them.
+    std::deque<NodeId> queue;
+
+    for (auto const &p : _waveDirtyPorts) {
+        if (_model.nodeExists(p.first) && _unfinished.insert(p.first).second)
+            queue.push_back(p.first);
+
+        _pathCounts[p.first] = p.second.size();
+    }
+
+    while (!queue.empty()) {
+        NodeId const nodeId = queue.front();
+        queue.pop_front();
+
+        _pendingPredecessors.emplace(nodeId, 0);
+
+        PortCount const nOutPorts = _model.portCount(nodeId, PortType::Out);
+
+        for (PortIndex portIndex = 0; portIndex < nOutPorts; ++portIndex) {
+            for (auto const &cn : _model.connections(nodeId, PortType::Out, portIndex)) {
+                ++_pendingPredecessors[cn.inNodeId];
+                _countedConnections.insert(cn);
+
+                if (_unfinished.insert(cn.inNodeId).second)
+                    queue.push_back(cn.inNodeId);
+            }
+        }
+    }
+
+    for (auto const &p : _pendingPredecessors) {
+        if (p.second == 0)
+            _ready.push_back(p.first);
+    }
+
+    Q_EMIT waveStarted();
+
+    processReadyNodes();
+}
+
+void DataFlowExecutor::processReadyNodes()
+{
+    // Synchronous nodes release their successors from inside the loop.
+    if (_processing)
+        return;
+
+    _processing = true;
+
+    while (!_ready.empty()) {
+        NodeId const nodeId = _ready.front();
+        _ready.pop_front();
+
+        _pendingPredecessors.erase(nodeId);
+
+        evaluate(nodeId);
+    }
+
+    _processing = false;
+
+    finishWaveIfIdle();
+}
+
+void DataFlowExecutor::evaluate(NodeId const nodeId)
+{
+    auto delegate = _model.delegateModel<NodeDelegateModel>(nodeId);
+
+    auto dirtyIt = _waveDirtyPorts.find(nodeId);
+
+    // None of the predecessors produced new data.
+    if (!delegate || dirtyIt == _waveDirtyPorts.end()) {
+        finishNode(nodeId, {});
+        return;
+    }
+
+    std::set<PortIndex> const dirtyPorts = std::move(dirtyIt->second);
+    _waveDirtyPorts.erase(dirtyIt);
+
+    ++_stats.evaluations;
+    _stats.depthFirstEvaluations += _pathCounts[nodeId];
+
+    if (_threaded && delegate->computeInBackground()) {
+        PortCount const nInPorts = _model.portCount(nodeId, PortType::In);
+
+        std::vector<std::shared_ptr<NodeData>> inputs;
+        inputs.reserve(nInPorts);
+
+        for (PortIndex portIndex = 0; portIndex < nInPorts; ++portIndex) {
+            inputs.push_back(inputData(nodeId, portIndex));
+        }
+
+        dispatch(nodeId, std::move(inputs), dirtyPorts);
+        return;
+    }
+
+    std::vector<std::pair<PortIndex, std::shared_ptr<NodeData>>> inputs;
+    inputs.reserve(dirtyPorts.size());
+
+    for (PortIndex const portIndex : dirtyPorts) {
+        inputs.emplace_back(portIndex, inputData(nodeId, portIndex));
+    }
+
+    _evaluatingNode = nodeId;
+    _emittedPorts.clear();
+
+    delegate->setInDataBatch(inputs);
+
+    _evaluatingNode = InvalidNodeId;
+
+    // Triggers repainting on the scene.
+    for (PortIndex const portIndex : dirtyPorts) {
+        Q_EMIT _model.inPortDataWasSet(nodeId, PortType::In, portIndex);
+    }
+
+    finishNode(nodeId, _emittedPorts);
+}
+
+void DataFlowExecutor::dispatch(NodeId const nodeId,
+                                std::vector<std::shared_ptr<NodeData>> inputs,
+                                std::set<PortIndex> dirtyPorts)
+{
+    auto delegate = _model.delegateModel<NodeDelegateModel>(nodeId);
+
+    _running.insert(nodeId);
+
+    Q_EMIT delegate->computingStarted();
+
+    auto task = [this, nodeId, delegate, inputs, dirtyPorts]() {
+        std::vector<std::shared_ptr<NodeData>> outputs = delegate->compute(inputs);
+
+        QMetaObject::invokeMethod(
+            this,
+            [this, nodeId, delegate, dirtyPorts, inputs, outputs]() {
+                onNodeComputed(nodeId, delegate, dirtyPorts, inputs, outputs);
+            },
+            Qt::QueuedConnection);
+    };
+
+    _threadPool.start(new ComputeTask(task));
+}
+
+void DataFlowExecutor::onNodeComputed(NodeId const nodeId,
+                                      NodeDelegateModel const *computed,
+                                      std::set<PortIndex> const &dirtyPorts,
+                                      std::vector<std::shared_ptr<NodeData>> const &inputs,
+                                      std::vector<std::shared_ptr<NodeData>> const &outputs)
+{
+    // The node was deleted while it was being computed, the task is done
+    // with its delegate now.
+    if (_detached.erase(computed) > 0)
+        return;
+
+    if (_running.erase(nodeId) == 0)
+        return;
+
+    auto delegate = _model.delegateModel<NodeDelegateModel>(nodeId);
+
+    _evaluatingNode = nodeId;
+
+    delegate->setComputedData(inputs, outputs);
+
+    _evaluatingNode = InvalidNodeId;
+
+    Q_EMIT delegate->computingFinished();
+
+    // Triggers repainting on the scene.
+    for (PortIndex const portIndex : dirtyPorts) {
+        Q_EMIT _model.inPortDataWasSet(nodeId, PortType::In, portIndex);
+    }
+
+    std::set<PortIndex> changedPorts;
+    for (PortIndex portIndex = 0; portIndex < outputs.size(); ++portIndex) {
+        changedPorts.insert(portIndex);
+    }
+
+    finishNode(nodeId, changedPorts);
+
+    processReadyNodes();
+}
+
+void DataFlowExecutor::finishNode(NodeId const nodeId, std::set<PortIndex> const &changedPorts)
+{
+    _unfinished.erase(nodeId);
+
+    quint64 const pathCount = _pathCounts[nodeId];
+
+    PortCount const nOutPorts = _model.portCount(nodeId, PortType::Out);
+
+    for (PortIndex portIndex = 0; portIndex < nOutPorts; ++portIndex) {
+        bool const changed = changedPorts.count(portIndex) > 0;
+
+        for (auto const &cn : _model.connections(nodeId, PortType::Out, portIndex)) {
+            if (_countedConnections.erase(cn) == 0) {
+                // The connection appeared during the wave, evaluate in the next one.
+                if (changed)
+                    _dirtyPorts[cn.inNodeId].insert(cn.inPortIndex);
+
+                continue;
+            }
+
+            if (changed) {
+                _waveDirtyPorts[cn.inNodeId].insert(cn.inPortIndex);
+                _pathCounts[cn.inNodeId] += pathCount;
+            }
+
+            auto it = _pendingPredecessors.find(cn.inNodeId);
+            if (it != _pendingPredecessors.end() && it->second > 0 && --it->second == 0)
+                _ready.push_back(cn.inNodeId);
+        }
+    }
+}
+
+void DataFlowExecutor::finishWaveIfIdle()
+{
+    if (!_waveActive || _processing || !_ready.empty() || !_running.empty())
+        return;
+
+    // Nodes left here are part of a cycle and can never become ready.
+    if (!_unfinished.empty()) {
+        _stats.cycleSkips += _unfinished.size();
+
+        qWarning() << "DataFlowExecutor: skipped" << _unfinished.size()
+                   << "nodes which are part of a cycle";
+    }
+
+    _waveDirtyPorts.clear();
+    _unfinished.clear();
+    _pendingPredecessors.clear();
+    _countedConnections.clear();
+    _pathCounts.clear();
+
+    _waveActive = false;
+
+    ++_stats.waves;
+
+    Q_EMIT waveFinished();
+
+    // Changes made during the wave start the next one from the event loop.
+    if (!_dirtyPorts.empty()) {
+        QMetaObject::invokeMethod(
+            this,
+            [this]() {
+                if (!_waveActive)
+                    startWave();
+            },
+            Qt::QueuedConnection);
+    }
+}
+
+std::shared_ptr<NodeData> DataFlowExecutor::inputData(NodeId const nodeId,
+                                                      PortIndex const portIndex) const
+{
+    auto const connected = _model.connections(nodeId, PortType::In, portIndex);
+
+    if (connected.empty())
+        return nullptr;
+
+    ConnectionId const cn = *connected.begin();
+
+    return _model.portData<std::shared_ptr<NodeData>>(cn.outNodeId,
+                                                      PortType::Out,
+                                                      cn.outPortIndex,
+                                                      PortRole::Data);
+}
+
+} // namespace QtNodes
@@ -0,0 +1,322 @@
+#include "DataFlowGraphLoader.hpp"
+
+#include "ConnectionIdUtils.hpp"
+
+#include <QtCore/QDataStream>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace QtNodes {
+
+namespace {
+
+/// Nodes or connections per JSON batch, the time slice is checked between batches.
+constexpr std::size_t BatchSize = 256;
+
+/// Bytes read from a JSON file between two checks for a cancellation.
+constexpr qint64 ReadChunkSize = 1 << 20;
+
+} // namespace
+
+DataFlowGraphLoader::DataFlowGraphLoader(DataFlowGraphModel &model, QObject *parent)
+    : QObject(parent)
+    , _model(model)
+    , _timeSlice(8)
+    , _running(false)
+    , _loadedNodes(0)
+    , _loadedConnections(0)
+{
+    _timer.setInterval(0);
+
+    connect(&_timer, &QTimer::timeout, this, &DataFlowGraphLoader::insertBatches);
+}
+
+DataFlowGraphLoader::~DataFlowGraphLoader()
+{
+    cancel();
+
+    if (_worker.joinable())
+        _worker.join();
+}
+
+bool DataFlowGraphLoader::start(QString const &fileName)
+{
+    if (_running || !QFileInfo(fileName).isReadable())
+        return false;
+
+    _running = true;
+    _loadedNodes = 0;
+    _loadedConnections = 0;
+
+    if (_worker.joinable())
+        _worker.join();
+
+    _job = std::make_shared<Job>();
+    _job->timer = &_timer;
+
+    _worker = std::thread(&DataFlowGraphLoader::parse, _job, fileName);
+
+    return true;
+}
+
+void DataFlowGraphLoader::cancel()
+{
+    if (!_running)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(_job->mutex);
+
+        _job->cancelled = true;
+        _job->timer = nullptr;
+        _job->batches.clear();
+    }
+
+    _job.reset();
+
+    _timer.stop();
+
+    _running = false;
+}
+
+void DataFlowGraphLoader::parse(std::shared_ptr<Job> job, QString const fileName)
+{
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        finishParsing(*job, false);
+        return;
+    }
+
+    if (DataFlowGraphModel::isBinaryFormat(&file)) {
+        QDataStream in(&file);
+        parseBinary(*job, in);
+        return;
+    }
+
+    QByteArray data;
+
+    if (readAll(*job, file, data))
+        parseJson(*job, data);
+}
+
+bool DataFlowGraphLoader::readAll(Job &job, QIODevice &device, QByteArray &data)
+{
+    data.reserve(static_cast<int>(device.size()));
+
+    while (!device.atEnd()) {
+        if (job.cancelled)
+            return false;
+
+        QByteArray const chunk = device.read(ReadChunkSize);
+
+        if (chunk.isEmpty()) {
+            finishParsing(job, false);
+            return false;
+        }
+
+        data.append(chunk);
+    }
+
+    return true;
+}
+
+void DataFlowGraphLoader::parseJson(Job &job, QByteArray const &data)
+{
+    QJsonParseError error;
+    QJsonDocument const document = QJsonDocument::fromJson(data, &error);
+
+    if (job.cancelled)
+        return;
+
+    if (error.error != QJsonParseError::NoError) {
+        finishParsing(job, false);
+        return;
+    }
+
+    QJsonObject const json = document.object();
+
+    QJsonArray const nodesJsonArray = json["nodes"].toArray();
+
+    Batch batch;
+
+    for (QJsonValue const nodeJson : nodesJsonArray) {
+        if (job.cancelled)
+            return;
+
+        batch.nodes.push_back(nodeJson.toObject());
+
+        if (batch.nodes.size() == BatchSize) {
+            push(job, std::move(batch));
+            batch = Batch();
+        }
+    }
+
+    // Connections are only queued after all the nodes, their ends must exist.
+    if (!batch.nodes.empty()) {
+        push(job, std::move(batch));
+        batch = Batch();
+    }
+
+    QJsonArray const connectionJsonArray = json["connections"].toArray();
+
+    for (QJsonValue const connection : connectionJsonArray) {
+        if (job.cancelled)
+            return;
+
+        batch.connections.push_back(fromJson(connection.toObject()));
+
+        if (batch.connections.size() == BatchSize) {
+            push(job, std::move(batch));
+            batch = Batch();
+        }
+    }
+
+    if (!batch.connections.empty())
+        push(job, std::move(batch));
+
+    finishParsing(job, true);
+}
+
+void DataFlowGraphLoader::parseBinary(Job &job, QDataStream &in)
+{
+    if (!DataFlowGraphModel::readBinaryHeader(in)) {
+        finishParsing(job, false);
+        return;
+    }
+
+    Batch batch;
+
+    while (!job.cancelled && DataFlowGraphModel::readBinaryChunk(in, batch.chunk)) {
+        push(job, std::move(batch));
+        batch = Batch();
+    }
+
+    finishParsing(job, in.status() == QDataStream::Ok);
+}
+
+void DataFlowGraphLoader::push(Job &job, Batch batch)
+{
+    std::lock_guard<std::mutex> lock(job.mutex);
+
+    // Nobody will read the batch after a cancel.
+    if (!job.timer)
+        return;
+
+    bool const wakeUp = job.batches.empty();
+
+    job.batches.push_back(std::move(batch));
+
+    // The timer lives in the GUI thread and stops whenever the queue runs dry.
+    // Posting under the lock keeps `cancel()` from destroying it in between.
+    if (wakeUp)
+        QMetaObject::invokeMethod(job.timer, "start", Qt::QueuedConnection);
+}
+
+void DataFlowGraphLoader::finishParsing(Job &job, bool success)
+{
+    std::lock_guard<std::mutex> lock(job.mutex);
+
+    job.parsingDone = true;
+    job.parsingSucceeded = success;
+
+    if (job.timer)
+        QMetaObject::invokeMethod(job.timer, "start", Qt::QueuedConnection);
+}
+
+void DataFlowGraphLoader::insertBatches()
+{
+    if (!_running) {
+        _timer.stop();
+        return;
+    }
+
+    QElapsedTimer clock;
+    clock.start();
+
+    while (clock.elapsed() < _timeSlice) {
+        Batch batch;
+        bool haveBatch = false;
+        bool parsingDone = false;
+        bool parsingSucceeded = false;
+
+        {
+            std::lock_guard<std::mutex> lock(_job->mutex);
+
+            if (_job->batches.empty()) {
+                parsingDone = _job->parsingDone;
+                parsingSucceeded = _job->parsingSucceeded;
+            } else {
+                batch = std::move(_job->batches.front());
+                _job->batches.pop_front();
+                haveBatch = true;
+            }
+        }
+
+        if (parsingDone) {
+            finish(parsingSucceeded);
+            return;
+        }
+
+        // Waiting for the worker to queue more.
+        if (!haveBatch) {
+            _timer.stop();
+            break;
+        }
+
+        try {
+            insertBatch(batch);
+        } catch (std::logic_error const &) {
+            // Unknown node model.
+            finish(false);
+            return;
+        }
+    }
+
+    Q_EMIT progress(_loadedNodes, _loadedConnections);
+}
+
+void DataFlowGraphLoader::insertBatch(Batch const &batch)
+{
+    // The scene handles the whole batch in one pass.
+    ScopedGraphBatch graphBatch(_model);
+
+    for (QJsonObject const &nodeJson : batch.nodes) {
+        _model.loadNode(nodeJson);
+    }
+
+    _loadedNodes += batch.nodes.size();
+
+    for (ConnectionId const &connectionId : batch.connections) {
+        _model.addConnection(connectionId);
+    }
+
+    _loadedConnections += batch.connections.size();
+
+    if (batch.chunk.count > 0) {
+        _model.loadBinaryChunk(batch.chunk);
+
+        if (batch.chunk.holdsNodes())
+            _loadedNodes += batch.chunk.count;
+        else if (batch.chunk.holdsConnections())
+            _loadedConnections += batch.chunk.count;
+    }
+}
+
+void DataFlowGraphLoader::finish(bool success)
+{
+    cancel();
+
+    Q_EMIT progress(_loadedNodes, _loadedConnections);
+
+    Q_EMIT finished(success);
+}
+
+} // namespace QtNodes
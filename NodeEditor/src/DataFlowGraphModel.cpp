@@ -1,16 +1,120 @@
 #include "DataFlowGraphModel.hpp"
 #include "ConnectionIdHash.hpp"
+#include "DataFlowExecutor.hpp"
 
+#include <QBuffer>
 #include <QJsonArray>
 
 #include <stdexcept>
 
 namespace QtNodes {
 
+namespace {
+
+/// "QNDF", QtNodes data flow.
+constexpr quint32 BinaryMagic = 0x514E4446;
+
+constexpr quint32 BinaryVersion = 1;
+
+constexpr quint32 NodesChunk = 0x4E4F4445;       // "NODE"
+constexpr quint32 ConnectionsChunk = 0x434F4E4E; // "CONN"
+constexpr quint32 EndChunk = 0x454E4421;         // "END!"
+
+/// Records per chunk, keeps the transient buffers small.
+constexpr quint32 ChunkSize = 1024;
+
+/**
+ * Collects records into a buffer and writes them out as
+ * `tag, record count, payload` chunks of at most `ChunkSize` records.
+ */
+class ChunkWriter
+{
+public:
+    ChunkWriter(QDataStream &out, quint32 tag)
+        : _out(out)
+        , _tag(tag)
+        , _count(0)
+    {
+        _buffer.open(QIODevice::WriteOnly);
+        _stream.setDevice(&_buffer);
+        _stream.setVersion(out.version());
+    }
+
+    ~ChunkWriter() { flush(); }
+
+    /// Returns the stream for the next record.
+    QDataStream &next()
+    {
+        if (_count == ChunkSize)
+            flush();
+
+        ++_count;
+        return _stream;
+    }
+
+    void flush()
+    {
+        if (_count == 0)
+            return;
+
+        _out << _tag << _count << _buffer.data();
+
+        _buffer.buffer().clear();
+        _buffer.seek(0);
+        _count = 0;
+    }
+
+private:
+    QDataStream &_out;
+    quint32 _tag;
+    quint32 _count;
+    QBuffer _buffer;
+    QDataStream _stream;
+};
+
+} // namespace
+
 DataFlowGraphModel::DataFlowGraphModel(std::shared_ptr<NodeDelegateModelRegistry> registry)
     : _registry(std::move(registry))
     , _nextNodeId{0}
-{}
+    , _propagationMode(PropagationMode::Immediate)
+{
+    // The scene skips `inPortDataWasSet` during a batch and updates the node
+    // from `graphChanged` instead.
+    connect(this,
+            &DataFlowGraphModel::inPortDataWasSet,
+            this,
+            [this](NodeId const nodeId, PortType const, PortIndex const) {
+                recordUpdatedNode(nodeId);
+            });
+}
+
+DataFlowGraphModel::~DataFlowGraphModel()
+{
+    //
+}
+
+void DataFlowGraphModel::setPropagationMode(PropagationMode mode)
+{
+    if (_propagationMode == mode)
+        return;
+
+    _propagationMode = mode;
+
+    if (mode == PropagationMode::Immediate) {
+        // The running nodes get their results and `computingFinished` first.
+        if (_executor)
+            _executor->finish();
+
+        _executor.reset();
+        return;
+    }
+
+    if (!_executor)
+        _executor = std::make_unique<DataFlowExecutor>(*this);
+
+    _executor->setThreaded(mode == PropagationMode::Threaded);
+}
 
 std::unordered_set<NodeId> DataFlowGraphModel::allNodeIds() const
 {
@@ -22,33 +126,22 @@ std::unordered_set<NodeId> DataFlowGraphModel::allNodeIds() const
 
 std::unordered_set<ConnectionId> DataFlowGraphModel::allConnectionIds(NodeId const nodeId) const
 {
-    std::unordered_set<ConnectionId> result;
-
-    std::copy_if(_connectivity.begin(),
-                 _connectivity.end(),
-                 std::inserter(result, std::end(result)),
-                 [&nodeId](ConnectionId const &cid) {
-                     return cid.inNodeId == nodeId || cid.outNodeId == nodeId;
-                 });
+    auto it = _nodeConnections.find(nodeId);
+    if (it == _nodeConnections.end())
+        return {};
 
-    return result;
+    return it->second;
 }
 
 std::unordered_set<ConnectionId> DataFlowGraphModel::connections(NodeId nodeId,
                                                                  PortType portType,
                                                                  PortIndex portIndex) const
 {
-    std::unordered_set<ConnectionId> result;
-
-    std::copy_if(_connectivity.begin(),
-                 _connectivity.end(),
-                 std::inserter(result, std::end(result)),
-                 [&portType, &portIndex, &nodeId](ConnectionId const &cid) {
-                     return (getNodeId(portType, cid) == nodeId
-                             && getPortIndex(portType, cid) == portIndex);
-                 });
+    auto it = _portConnections.find(std::make_tuple(nodeId, portType, portIndex));
+    if (it == _portConnections.end())
+        return {};
 
-    return result;
+    return it->second;
 }
 
 bool DataFlowGraphModel::connectionExists(ConnectionId const connectionId) const
@@ -105,12 +198,10 @@ NodeId DataFlowGraphModel::addNode(QString const nodeType)
 
 bool DataFlowGraphModel::connectionPossible(ConnectionId const connectionId) const
 {
-    auto getDataType = [&](PortType const portType) {
-        return portData(getNodeId(portType, connectionId),
-                        portType,
-                        getPortIndex(portType, connectionId),
-                        PortRole::DataType)
-            .value<NodeDataType>();
+    auto getTypeHandle = [&](PortType const portType) {
+        return portDataTypeHandle(getNodeId(portType, connectionId),
+                                  portType,
+                                  getPortIndex(portType, connectionId));
     };
 
     auto portVacant = [&](PortType const portType) {
@@ -124,7 +215,7 @@ bool DataFlowGraphModel::connectionPossible(ConnectionId const connectionId) con
         return connected.empty() || (policy == ConnectionPolicy::Many);
     };
 
-    return getDataType(PortType::Out).id == getDataType(PortType::In).id
+    return getTypeHandle(PortType::Out) == getTypeHandle(PortType::In)
            && portVacant(PortType::Out) && portVacant(PortType::In);
 }
 
@@ -132,8 +223,15 @@ void DataFlowGraphModel::addConnection(ConnectionId const connectionId)
 {
     _connectivity.insert(connectionId);
 
+    indexConnection(connectionId);
+
     sendConnectionCreation(connectionId);
 
+    if (_executor) {
+        _executor->inPortDataChanged(connectionId.inNodeId, connectionId.inPortIndex);
+        return;
+    }
+
     QVariant const portDataToPropagate = portData(connectionId.outNodeId,
                                                   PortType::Out,
                                                   connectionId.outPortIndex,
@@ -160,6 +258,46 @@ void DataFlowGraphModel::sendConnectionCreation(ConnectionId const connectionId)
     }
 }
 
+void DataFlowGraphModel::indexConnection(ConnectionId const connectionId)
+{
+    _portConnections[std::make_tuple(connectionId.outNodeId,
+                                     PortType::Out,
+                                     connectionId.outPortIndex)]
+        .insert(connectionId);
+    _portConnections[std::make_tuple(connectionId.inNodeId, PortType::In, connectionId.inPortIndex)]
+        .insert(connectionId);
+
+    _nodeConnections[connectionId.outNodeId].insert(connectionId);
+    _nodeConnections[connectionId.inNodeId].insert(connectionId);
+}
+
+void DataFlowGraphModel::unindexConnection(ConnectionId const connectionId)
+{
+    auto erasePort = [&](PortKey const &key) {
+        auto it = _portConnections.find(key);
+        if (it != _portConnections.end()) {
+            it->second.erase(connectionId);
+            if (it->second.empty())
+                _portConnections.erase(it);
+        }
+    };
+
+    auto eraseNode = [&](NodeId const nodeId) {
+        auto it = _nodeConnections.find(nodeId);
+        if (it != _nodeConnections.end()) {
+            it->second.erase(connectionId);
+            if (it->second.empty())
+                _nodeConnections.erase(it);
+        }
+    };
+
+    erasePort(std::make_tuple(connectionId.outNodeId, PortType::Out, connectionId.outPortIndex));
+    erasePort(std::make_tuple(connectionId.inNodeId, PortType::In, connectionId.inPortIndex));
+
+    eraseNode(connectionId.outNodeId);
+    eraseNode(connectionId.inNodeId);
+}
+
 void DataFlowGraphModel::sendConnectionDeletion(ConnectionId const connectionId)
 {
     Q_EMIT connectionDeleted(connectionId);
@@ -211,7 +349,7 @@ QVariant DataFlowGraphModel::nodeData(NodeId nodeId, NodeRole role) const
         break;
 
     case NodeRole::Style: {
-        auto style = StyleCollection::nodeStyle();
+        auto const &style = model->nodeStyle();
         result = style.toJson().toVariantMap();
     } break;
 
@@ -241,6 +379,111 @@ QVariant DataFlowGraphModel::nodeData(NodeId nodeId, NodeRole role) const
     return result;
 }
 
+NodeStyle const &DataFlowGraphModel::nodeStyle(NodeId nodeId) const
+{
+    auto it = _models.find(nodeId);
+    if (it == _models.end())
+        return StyleCollection::nodeStyle();
+
+    return it->second->nodeStyle();
+}
+
+QSize DataFlowGraphModel::nodeSize(NodeId nodeId) const
+{
+    auto it = _nodeGeometryData.find(nodeId);
+    if (it == _nodeGeometryData.end())
+        return QSize();
+
+    return it->second.size;
+}
+
+PortCount DataFlowGraphModel::portCount(NodeId nodeId, PortType portType) const
+{
+    auto it = _models.find(nodeId);
+    if (it == _models.end())
+        return 0;
+
+    return it->second->nPorts(portType);
+}
+
+bool DataFlowGraphModel::nodeCaptionVisible(NodeId nodeId) const
+{
+    auto it = _models.find(nodeId);
+    if (it == _models.end())
+        return false;
+
+    return it->second->captionVisible();
+}
+
+QString DataFlowGraphModel::nodeCaption(NodeId nodeId) const
+{
+    auto it = _models.find(nodeId);
+    if (it == _models.end())
+        return QString();
+
+    return it->second->caption();
+}
+
+QWidget *DataFlowGraphModel::nodeWidget(NodeId nodeId) const
+{
+    auto it = _models.find(nodeId);
+    if (it == _models.end())
+        return nullptr;
+
+    return it->second->embeddedWidget();
+}
+
+NodeDataType DataFlowGraphModel::portDataType(NodeId nodeId,
+                                              PortType portType,
+                                              PortIndex portIndex) const
+{
+    auto it = _models.find(nodeId);
+    if (it == _models.end())
+        return NodeDataType();
+
+    return it->second->dataType(portType, portIndex);
+}
+
+DataTypeHandle DataFlowGraphModel::portDataTypeHandle(NodeId nodeId,
+                                                      PortType portType,
+                                                      PortIndex portIndex) const
+{
+    auto it = _models.find(nodeId);
+    if (it == _models.end())
+        return InvalidDataTypeHandle;
+
+    return it->second->dataTypeHandle(portType, portIndex);
+}
+
+bool DataFlowGraphModel::portCaptionVisible(NodeId nodeId,
+                                            PortType portType,
+                                            PortIndex portIndex) const
+{
+    auto it = _models.find(nodeId);
+    if (it == _models.end())
+        return false;
+
+    return it->second->portCaptionVisible(portType, portIndex);
+}
+
+QString DataFlowGraphModel::portCaption(NodeId nodeId,
+                                        PortType portType,
+                                        PortIndex portIndex) const
+{
+    auto it = _models.find(nodeId);
+    if (it == _models.end())
+        return QString();
+
+    return it->second->portCaption(portType, portIndex);
+}
+
+bool DataFlowGraphModel::portConnected(NodeId nodeId,
+                                       PortType portType,
+                                       PortIndex portIndex) const
+{
+    return _portConnections.count(std::make_tuple(nodeId, portType, portIndex)) > 0;
+}
+
 NodeFlags DataFlowGraphModel::nodeFlags(NodeId nodeId) const
 {
     auto it = _models.find(nodeId);
@@ -281,8 +524,18 @@ bool DataFlowGraphModel::setNodeData(NodeId nodeId, NodeRole role, QVariant valu
     case NodeRole::Caption:
         break;
 
-    case NodeRole::Style:
-        break;
+    case NodeRole::Style: {
+        auto it = _models.find(nodeId);
+        if (it == _models.end())
+            break;
+
+        QJsonObject const styleJson = QJsonObject::fromVariantMap(value.toMap());
+        it->second->setNodeStyle(NodeStyle(styleJson));
+
+        Q_EMIT nodeUpdated(nodeId);
+
+        result = true;
+    } break;
 
     case NodeRole::InternalData:
         break;
@@ -380,9 +633,14 @@ bool DataFlowGraphModel::deleteConnection(ConnectionId const connectionId)
         disconnected = true;
 
         _connectivity.erase(it);
+
+        unindexConnection(connectionId);
     }
 
     if (disconnected) {
+        if (_executor)
+            _executor->connectionDeleted(connectionId);
+
         sendConnectionDeletion(connectionId);
 
         propagateEmptyDataTo(getNodeId(PortType::In, connectionId),
@@ -401,7 +659,16 @@ bool DataFlowGraphModel::deleteNode(NodeId const nodeId)
     }
 
     _nodeGeometryData.erase(nodeId);
-    _models.erase(nodeId);
+
+    auto it = _models.find(nodeId);
+    if (it != _models.end()) {
+        std::unique_ptr<NodeDelegateModel> delegate = std::move(it->second);
+        _models.erase(it);
+
+        // The executor keeps the delegate alive while its computation is running.
+        if (_executor)
+            _executor->nodeDeleted(nodeId, std::move(delegate));
+    }
 
     Q_EMIT nodeDeleted(nodeId);
 
@@ -458,39 +725,82 @@ void DataFlowGraphModel::loadNode(QJsonObject const &nodeJson)
     // because all the new ids were created past the removed nodes.
     NodeId restoredNodeId = nodeJson["id"].toInt();
 
-    _nextNodeId = std::max(_nextNodeId, restoredNodeId + 1);
-
     QJsonObject const internalDataJson = nodeJson["internal-data"].toObject();
 
     QString delegateModelName = internalDataJson["model-name"].toString();
 
-    std::unique_ptr<NodeDelegateModel> model = _registry->create(delegateModelName);
+    NodeDelegateModel *model = restoreNode(restoredNodeId, delegateModelName);
 
-    if (model) {
-        connect(model.get(),
-                &NodeDelegateModel::dataUpdated,
-                [restoredNodeId, this](PortIndex const portIndex) {
-                    onOutPortDataUpdated(restoredNodeId, portIndex);
-                });
+    QJsonObject posJson = nodeJson["position"].toObject();
+    QPointF const pos(posJson["x"].toDouble(), posJson["y"].toDouble());
+
+    setNodeData(restoredNodeId, NodeRole::Position, pos);
 
-        _models[restoredNodeId] = std::move(model);
+    model->load(internalDataJson);
+}
 
-        Q_EMIT nodeCreated(restoredNodeId);
+QByteArray DataFlowGraphModel::saveNodeState(NodeId const nodeId) const
+{
+    auto const &model = _models.at(nodeId);
 
-        QJsonObject posJson = nodeJson["position"].toObject();
-        QPointF const pos(posJson["x"].toDouble(), posJson["y"].toDouble());
+    QByteArray state;
+    {
+        QDataStream out(&state, QIODevice::WriteOnly);
+        out.setVersion(QDataStream::Qt_5_12);
 
-        setNodeData(restoredNodeId, NodeRole::Position, pos);
+        out << model->name();
 
-        _models[restoredNodeId]->load(internalDataJson);
-    } else {
+        model->saveBinary(out);
+    }
+
+    return state;
+}
+
+void DataFlowGraphModel::loadNodeState(NodeId const nodeId,
+                                       QPointF const &position,
+                                       QByteArray const &state)
+{
+    QDataStream in(state);
+    in.setVersion(QDataStream::Qt_5_12);
+
+    QString modelName;
+    in >> modelName;
+
+    NodeDelegateModel *model = restoreNode(nodeId, modelName);
+
+    setNodeData(nodeId, NodeRole::Position, position);
+
+    model->loadBinary(in);
+}
+
+NodeDelegateModel *DataFlowGraphModel::restoreNode(NodeId const nodeId, QString const &modelName)
+{
+    _nextNodeId = std::max(_nextNodeId, nodeId + 1);
+
+    std::unique_ptr<NodeDelegateModel> model = _registry->create(modelName);
+
+    if (!model) {
         throw std::logic_error(std::string("No registered model with name ")
-                               + delegateModelName.toLocal8Bit().data());
+                               + modelName.toLocal8Bit().data());
     }
+
+    connect(model.get(), &NodeDelegateModel::dataUpdated, [nodeId, this](PortIndex const portIndex) {
+        onOutPortDataUpdated(nodeId, portIndex);
+    });
+
+    NodeDelegateModel *result = model.get();
+
+    _models[nodeId] = std::move(model);
+
+    Q_EMIT nodeCreated(nodeId);
+
+    return result;
 }
 
 void DataFlowGraphModel::load(QJsonObject const &jsonDocument)
 {
+    ScopedGraphBatch batch(*this);
+
     QJsonArray nodesJsonArray = jsonDocument["nodes"].toArray();
 
     for (QJsonValueRef nodeJson : nodesJsonArray) {
@@ -509,8 +819,177 @@ void DataFlowGraphModel::load(QJsonObject const &jsonDocument)
     }
 }
 
+void DataFlowGraphModel::saveNodeBinary(NodeId const nodeId, QDataStream &out) const
+{
+    auto const &model = _models.at(nodeId);
+
+    // The delegate writes into its own buffer, so a model reading back less
+    // than it wrote cannot break the rest of the stream.
+    QByteArray internalData;
+    {
+        QDataStream internalStream(&internalData, QIODevice::WriteOnly);
+        internalStream.setVersion(out.version());
+
+        model->saveBinary(internalStream);
+    }
+
+    out << static_cast<quint32>(nodeId) << model->name()
+        << nodeData(nodeId, NodeRole::Position).value<QPointF>() << internalData;
+}
+
+void DataFlowGraphModel::loadNodeBinary(QDataStream &in)
+{
+    quint32 nodeId;
+    QString modelName;
+    QPointF pos;
+    QByteArray internalData;
+
+    in >> nodeId >> modelName >> pos >> internalData;
+
+    if (in.status() != QDataStream::Ok)
+        return;
+
+    NodeDelegateModel *model = restoreNode(nodeId, modelName);
+
+    setNodeData(nodeId, NodeRole::Position, pos);
+
+    QDataStream internalStream(internalData);
+    internalStream.setVersion(in.version());
+
+    model->loadBinary(internalStream);
+}
+
+void DataFlowGraphModel::saveBinary(QDataStream &out) const
+{
+    out.setVersion(QDataStream::Qt_5_12);
+
+    out << BinaryMagic << BinaryVersion;
+
+    {
+        ChunkWriter nodes(out, NodesChunk);
+
+        for (auto const &p : _models) {
+            saveNodeBinary(p.first, nodes.next());
+        }
+    }
+
+    {
+        ChunkWriter connections(out, ConnectionsChunk);
+
+        for (auto const &cid : _connectivity) {
+            connections.next() << cid;
+        }
+    }
+
+    out << EndChunk;
+}
+
+void DataFlowGraphModel::loadBinary(QDataStream &in)
+{
+    if (!readBinaryHeader(in))
+        return;
+
+    ScopedGraphBatch batch(*this);
+
+    BinaryChunk chunk;
+
+    while (readBinaryChunk(in, chunk)) {
+        loadBinaryChunk(chunk);
+    }
+}
+
+bool DataFlowGraphModel::BinaryChunk::holdsNodes() const
+{
+    return tag == NodesChunk;
+}
+
+bool DataFlowGraphModel::BinaryChunk::holdsConnections() const
+{
+    return tag == ConnectionsChunk;
+}
+
+bool DataFlowGraphModel::readBinaryHeader(QDataStream &in)
+{
+    in.setVersion(QDataStream::Qt_5_12);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+
+    in >> magic >> version;
+
+    if (magic != BinaryMagic || version > BinaryVersion) {
+        in.setStatus(QDataStream::ReadCorruptData);
+        return false;
+    }
+
+    return in.status() == QDataStream::Ok;
+}
+
+bool DataFlowGraphModel::readBinaryChunk(QDataStream &in, BinaryChunk &chunk)
+{
+    chunk.tag = EndChunk;
+    chunk.count = 0;
+    chunk.payload.clear();
+
+    in >> chunk.tag;
+
+    if (in.status() != QDataStream::Ok || chunk.tag == EndChunk)
+        return false;
+
+    in >> chunk.count >> chunk.payload;
+
+    return in.status() == QDataStream::Ok;
+}
+
+void DataFlowGraphModel::loadBinaryChunk(BinaryChunk const &chunk)
+{
+    QDataStream in(chunk.payload);
+    in.setVersion(QDataStream::Qt_5_12);
+
+    switch (chunk.tag) {
+    case NodesChunk:
+        for (quint32 i = 0; i < chunk.count && in.status() == QDataStream::Ok; ++i) {
+            loadNodeBinary(in);
+        }
+        break;
+
+    case ConnectionsChunk:
+        for (quint32 i = 0; i < chunk.count && in.status() == QDataStream::Ok; ++i) {
+            ConnectionId connId;
+            in >> connId;
+
+            addConnection(connId);
+        }
+        break;
+
+    default:
+        // Chunks added by newer versions are skipped.
+        break;
+    }
+}
+
+bool DataFlowGraphModel::isBinaryFormat(QIODevice *device)
+{
+    QByteArray const header = device->peek(sizeof(quint32));
+
+    if (header.size() < static_cast<int>(sizeof(quint32)))
+        return false;
+
+    QDataStream in(header);
+
+    quint32 magic = 0;
+    in >> magic;
+
+    return magic == BinaryMagic;
+}
+
 void DataFlowGraphModel::onOutPortDataUpdated(NodeId const nodeId, PortIndex const portIndex)
 {
+    if (_executor) {
+        _executor->outPortDataUpdated(nodeId, portIndex);
+        return;
+    }
+
     std::unordered_set<ConnectionId> const &connected = connections(nodeId,
                                                                     PortType::Out,
                                                                     portIndex);
@@ -524,6 +1003,11 @@ void DataFlowGraphModel::onOutPortDataUpdated(NodeId const nodeId, PortIndex con
 
 void DataFlowGraphModel::propagateEmptyDataTo(NodeId const nodeId, PortIndex const portIndex)
 {
+    if (_executor) {
+        _executor->inPortDataChanged(nodeId, portIndex);
+        return;
+    }
+
     QVariant emptyData{};
 
     setPortData(nodeId, PortType::In, portIndex, emptyData, PortRole::Data);
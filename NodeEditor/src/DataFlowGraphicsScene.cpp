@@ -31,10 +31,17 @@ namespace QtNodes {
 DataFlowGraphicsScene::DataFlowGraphicsScene(DataFlowGraphModel &graphModel, QObject *parent)
     : BasicGraphicsScene(graphModel, parent)
     , _graphModel(graphModel)
+    , _incrementalLoading(false)
+    , _loader(graphModel)
 {
     connect(&_graphModel,
             &DataFlowGraphModel::inPortDataWasSet,
             [this](NodeId const nodeId, PortType const, PortIndex const) { onNodeUpdated(nodeId); });
+
+    connect(&_loader, &DataFlowGraphLoader::finished, [this](bool success) {
+        if (success)
+            Q_EMIT sceneLoaded();
+    });
 }
 
 // TODO constructor for an empyt scene?
@@ -57,6 +64,14 @@ std::vector<NodeId> DataFlowGraphicsScene::selectedNodes() const
     return result;
 }
 
+void DataFlowGraphicsScene::setIncrementalLoading(bool incremental)
+{
+    _incrementalLoading = incremental;
+
+    if (_incrementalLoading)
+        setLazyGraphicsObjectCreation(true);
+}
+
 QMenu *DataFlowGraphicsScene::createSceneMenu(QPointF const scenePos)
 {
     QMenu *modelMenu = new QMenu();
@@ -146,17 +161,37 @@ QMenu *DataFlowGraphicsScene::createSceneMenu(QPointF const scenePos)
 
 bool DataFlowGraphicsScene::save() const
 {
+    QString const jsonFilter = tr("Flow Scene Files (*.flow)");
+    QString const binaryFilter = tr("Binary Flow Scene Files (*.flowb)");
+
+    QString selectedFilter = jsonFilter;
+
     QString fileName = QFileDialog::getSaveFileName(nullptr,
                                                     tr("Open Flow Scene"),
                                                     QDir::homePath(),
-                                                    tr("Flow Scene Files (*.flow)"));
+                                                    jsonFilter + ";;" + binaryFilter,
+                                                    &selectedFilter);
 
     if (!fileName.isEmpty()) {
-        if (!fileName.endsWith("flow", Qt::CaseInsensitive))
+        bool const binary = (selectedFilter == binaryFilter)
+                            || fileName.endsWith("flowb", Qt::CaseInsensitive);
+
+        if (binary) {
+            if (!fileName.endsWith("flowb", Qt::CaseInsensitive))
+                fileName += ".flowb";
+        } else if (!fileName.endsWith("flow", Qt::CaseInsensitive)) {
             fileName += ".flow";
+        }
 
         QFile file(fileName);
         if (file.open(QIODevice::WriteOnly)) {
+            if (binary) {
+                QDataStream out(&file);
+                _graphModel.saveBinary(out);
+
+                return out.status() == QDataStream::Ok;
+            }
+
             file.write(QJsonDocument(_graphModel.save()).toJson());
             return true;
         }
@@ -169,11 +204,19 @@ bool DataFlowGraphicsScene::load()
     QString fileName = QFileDialog::getOpenFileName(nullptr,
                                                     tr("Open Flow Scene"),
                                                     QDir::homePath(),
-                                                    tr("Flow Scene Files (*.flow)"));
+                                                    tr("Flow Scene Files (*.flow *.flowb)"));
 
     if (!QFileInfo::exists(fileName))
         return false;
 
+    if (_incrementalLoading) {
+        _loader.cancel();
+
+        clearScene();
+
+        return _loader.start(fileName);
+    }
+
     QFile file(fileName);
 
     if (!file.open(QIODevice::ReadOnly))
@@ -181,9 +224,18 @@ bool DataFlowGraphicsScene::load()
 
     clearScene();
 
-    QByteArray const wholeFile = file.readAll();
+    // The binary format is detected by its header, whatever the extension.
+    if (DataFlowGraphModel::isBinaryFormat(&file)) {
+        QDataStream in(&file);
+        _graphModel.loadBinary(in);
 
-    _graphModel.load(QJsonDocument::fromJson(wholeFile).object());
+        if (in.status() != QDataStream::Ok)
+            return false;
+    } else {
+        QByteArray const wholeFile = file.readAll();
+
+        _graphModel.load(QJsonDocument::fromJson(wholeFile).object());
+    }
 
     Q_EMIT sceneLoaded();
 
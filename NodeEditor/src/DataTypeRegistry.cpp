@@ -0,0 +1,86 @@
+#include "DataTypeRegistry.hpp"
+
+#include <QtCore/QHash>
+
+#include <random>
+
+namespace QtNodes {
+
+DataTypeRegistry &DataTypeRegistry::instance()
+{
+    static DataTypeRegistry registry;
+
+    return registry;
+}
+
+DataTypeHandle DataTypeRegistry::intern(QString const &typeId)
+{
+    {
+        QReadLocker locker(&_lock);
+
+        auto it = _handles.find(typeId);
+
+        if (it != _handles.end())
+            return it->second;
+    }
+
+    QWriteLocker locker(&_lock);
+
+    // Another thread may have been faster.
+    auto it = _handles.find(typeId);
+
+    if (it != _handles.end())
+        return it->second;
+
+    DataTypeHandle const handle = static_cast<DataTypeHandle>(_entries.size());
+
+    _entries.push_back(Entry{typeId, computeColor(typeId)});
+
+    _handles.emplace(typeId, handle);
+
+    return handle;
+}
+
+QString DataTypeRegistry::typeId(DataTypeHandle handle) const
+{
+    QReadLocker locker(&_lock);
+
+    if (handle >= _entries.size())
+        return QString();
+
+    return _entries[handle].typeId;
+}
+
+QColor DataTypeRegistry::color(DataTypeHandle handle) const
+{
+    QReadLocker locker(&_lock);
+
+    if (handle >= _entries.size())
+        return QColor();
+
+    return _entries[handle].color;
+}
+
+std::size_t DataTypeRegistry::size() const
+{
+    QReadLocker locker(&_lock);
+
+    return _entries.size();
+}
+
+QColor DataTypeRegistry::computeColor(QString const &typeId)
+{
+    std::size_t hash = qHash(typeId);
+
+    std::size_t const hue_range = 0xFF;
+
+    std::mt19937 gen(static_cast<unsigned int>(hash));
+    std::uniform_int_distribution<int> distrib(0, hue_range);
+
+    int hue = distrib(gen);
+    int sat = 120 + hash % 129;
+
+    return QColor::fromHsl(hue, sat, 160);
+}
+
+} // namespace QtNodes
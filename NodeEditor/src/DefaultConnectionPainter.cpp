@@ -1,8 +1,10 @@
 #include "DefaultConnectionPainter.hpp"
 
 #include <QtGui/QIcon>
+#include <QtWidgets/QStyleOptionGraphicsItem>
 
 #include "AbstractGraphModel.hpp"
+#include "BasicGraphicsScene.hpp"
 #include "ConnectionGraphicsObject.hpp"
 #include "ConnectionState.hpp"
 #include "Definitions.hpp"
@@ -97,21 +99,18 @@ void DefaultConnectionPainter::drawNormalLine(QPainter *painter, ConnectionGraph
 
         auto const cId = cgo.connectionId();
 
-        auto dataTypeOut = graphModel
-                               .portData(cId.outNodeId,
-                                         PortType::Out,
-                                         cId.outPortIndex,
-                                         PortRole::DataType)
-                               .value<NodeDataType>();
+        DataTypeHandle const typeOut = graphModel.portDataTypeHandle(cId.outNodeId,
+                                                                     PortType::Out,
+                                                                     cId.outPortIndex);
 
-        auto dataTypeIn
-            = graphModel.portData(cId.inNodeId, PortType::In, cId.inPortIndex, PortRole::DataType)
-                  .value<NodeDataType>();
+        DataTypeHandle const typeIn = graphModel.portDataTypeHandle(cId.inNodeId,
+                                                                    PortType::In,
+                                                                    cId.inPortIndex);
 
-        useGradientColor = (dataTypeOut.id != dataTypeIn.id);
+        useGradientColor = (typeOut != typeIn);
 
-        normalColorOut = connectionStyle.normalColor(dataTypeOut.id);
-        normalColorIn = connectionStyle.normalColor(dataTypeIn.id);
+        normalColorOut = connectionStyle.normalColor(typeOut);
+        normalColorIn = connectionStyle.normalColor(typeIn);
         selectedColor = normalColorOut.darker(200);
     }
 
@@ -175,8 +174,51 @@ void DefaultConnectionPainter::drawNormalLine(QPainter *painter, ConnectionGraph
     }
 }
 
+void DefaultConnectionPainter::drawSimplifiedLine(QPainter *painter,
+                                                  ConnectionGraphicsObject const &cgo,
+                                                  LevelOfDetail lod) const
+{
+    auto const &connectionStyle = QtNodes::StyleCollection::connectionStyle();
+
+    QColor color = connectionStyle.normalColor();
+
+    if (connectionStyle.useDataDefinedColors()) {
+        auto const cId = cgo.connectionId();
+
+        color = connectionStyle.normalColor(
+            cgo.graphModel().portDataTypeHandle(cId.outNodeId, PortType::Out, cId.outPortIndex));
+    }
+
+    if (cgo.isSelected())
+        color = connectionStyle.selectedColor();
+
+    QPen p(color);
+    p.setWidth(connectionStyle.lineWidth());
+
+    painter->setPen(p);
+    painter->setBrush(Qt::NoBrush);
+
+    if (lod == LevelOfDetail::Minimal) {
+        painter->setRenderHint(QPainter::Antialiasing, false);
+        painter->drawLine(cgo.out(), cgo.in());
+    } else {
+        painter->drawPath(cubicPath(cgo));
+    }
+}
+
 void DefaultConnectionPainter::paint(QPainter *painter, ConnectionGraphicsObject const &cgo) const
 {
+    qreal const scale = QStyleOptionGraphicsItem::levelOfDetailFromTransform(
+        painter->worldTransform());
+
+    LevelOfDetail const lod = cgo.nodeScene()->levelOfDetail(scale);
+
+    // The draft connection is always drawn in full, it is being edited.
+    if (lod != LevelOfDetail::Full && !cgo.connectionState().requiresPort()) {
+        drawSimplifiedLine(painter, cgo, lod);
+        return;
+    }
+
     drawHoveredOrSelected(painter, cgo);
 
     drawSketchLine(painter, cgo);
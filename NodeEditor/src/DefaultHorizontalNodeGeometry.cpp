@@ -25,34 +25,39 @@ DefaultHorizontalNodeGeometry::DefaultHorizontalNodeGeometry(AbstractGraphModel
 
 QSize DefaultHorizontalNodeGeometry::size(NodeId const nodeId) const
 {
-    return _graphModel.nodeData<QSize>(nodeId, NodeRole::Size);
+    return _graphModel.nodeSize(nodeId);
 }
 
 void DefaultHorizontalNodeGeometry::recomputeSize(NodeId const nodeId) const
 {
-    unsigned int height = maxVerticalPortsExtent(nodeId);
+    // Ports, caption or widget have changed.
+    invalidateLayout(nodeId);
 
-    if (auto w = _graphModel.nodeData<QWidget *>(nodeId, NodeRole::Widget)) {
+    NodeLayout const &l = measuredLayout(nodeId);
+
+    unsigned int const step = _portSize + _portSpasing;
+
+    // Finds max number of ports and multiplies by (a port height + interval)
+    unsigned int height = step
+                          * static_cast<unsigned int>(
+                              std::max(l.in.ports.size(), l.out.ports.size()));
+
+    if (auto w = _graphModel.nodeWidget(nodeId)) {
         height = std::max(height, static_cast<unsigned int>(w->height()));
     }
 
-    QRectF const capRect = captionRect(nodeId);
-
-    height += capRect.height();
+    height += l.captionRect.height();
 
     height += _portSpasing; // space above caption
     height += _portSpasing; // space below caption
 
-    unsigned int inPortWidth = maxPortsTextAdvance(nodeId, PortType::In);
-    unsigned int outPortWidth = maxPortsTextAdvance(nodeId, PortType::Out);
-
-    unsigned int width = inPortWidth + outPortWidth + 4 * _portSpasing;
+    unsigned int width = l.in.maxTextAdvance + l.out.maxTextAdvance + 4 * _portSpasing;
 
-    if (auto w = _graphModel.nodeData<QWidget *>(nodeId, NodeRole::Widget)) {
+    if (auto w = _graphModel.nodeWidget(nodeId)) {
         width += w->width();
     }
 
-    width = std::max(width, static_cast<unsigned int>(capRect.width()) + 2 * _portSpasing);
+    width = std::max(width, static_cast<unsigned int>(l.captionRect.width()) + 2 * _portSpasing);
 
     QSize size(width, height);
 
@@ -63,177 +68,164 @@ QPointF DefaultHorizontalNodeGeometry::portPosition(NodeId const nodeId,
                                                     PortType const portType,
                                                     PortIndex const portIndex) const
 {
-    unsigned int const step = _portSize + _portSpasing;
-
-    QPointF result;
-
-    double totalHeight = 0.0;
-
-    totalHeight += captionRect(nodeId).height();
-    totalHeight += _portSpasing;
-
-    totalHeight += step * portIndex;
-    totalHeight += step / 2.0;
-
-    QSize size = _graphModel.nodeData<QSize>(nodeId, NodeRole::Size);
-
-    switch (portType) {
-    case PortType::In: {
-        double x = 0.0;
-
-        result = QPointF(x, totalHeight);
-        break;
-    }
-
-    case PortType::Out: {
-        double x = size.width();
-
-        result = QPointF(x, totalHeight);
-        break;
-    }
-
-    default:
-        break;
-    }
-
-    return result;
+    return portLayout(nodeId, portType, portIndex).position;
 }
 
 QPointF DefaultHorizontalNodeGeometry::portTextPosition(NodeId const nodeId,
                                                         PortType const portType,
                                                         PortIndex const portIndex) const
 {
-    QPointF p = portPosition(nodeId, portType, portIndex);
-
-    QRectF rect = portTextRect(nodeId, portType, portIndex);
-
-    p.setY(p.y() + rect.height() / 4.0);
-
-    QSize size = _graphModel.nodeData<QSize>(nodeId, NodeRole::Size);
-
-    switch (portType) {
-    case PortType::In:
-        p.setX(_portSpasing);
-        break;
-
-    case PortType::Out:
-        p.setX(size.width() - _portSpasing - rect.width());
-        break;
-
-    default:
-        break;
-    }
-
-    return p;
+    return portLayout(nodeId, portType, portIndex).textPosition;
 }
 
 QRectF DefaultHorizontalNodeGeometry::captionRect(NodeId const nodeId) const
 {
-    if (!_graphModel.nodeData<bool>(nodeId, NodeRole::CaptionVisible))
-        return QRect();
-
-    QString name = _graphModel.nodeData<QString>(nodeId, NodeRole::Caption);
-
-    return _boldFontMetrics.boundingRect(name);
+    return measuredLayout(nodeId).captionRect;
 }
 
 QPointF DefaultHorizontalNodeGeometry::captionPosition(NodeId const nodeId) const
 {
-    QSize size = _graphModel.nodeData<QSize>(nodeId, NodeRole::Size);
-    return QPointF(0.5 * (size.width() - captionRect(nodeId).width()),
-                   0.5 * _portSpasing + captionRect(nodeId).height());
+    return layout(nodeId).captionPosition;
 }
 
 QPointF DefaultHorizontalNodeGeometry::widgetPosition(NodeId const nodeId) const
 {
-    QSize size = _graphModel.nodeData<QSize>(nodeId, NodeRole::Size);
-
-    unsigned int captionHeight = captionRect(nodeId).height();
-
-    if (auto w = _graphModel.nodeData<QWidget *>(nodeId, NodeRole::Widget)) {
-        // If the widget wants to use as much vertical space as possible,
-        // place it immediately after the caption.
-        if (w->sizePolicy().verticalPolicy() & QSizePolicy::ExpandFlag) {
-            return QPointF(2.0 * _portSpasing + maxPortsTextAdvance(nodeId, PortType::In),
-                           captionHeight);
-        } else {
-            return QPointF(2.0 * _portSpasing + maxPortsTextAdvance(nodeId, PortType::In),
-                           (captionHeight + size.height() - w->height()) / 2.0);
-        }
-    }
-    return QPointF();
+    return layout(nodeId).widgetPosition;
 }
 
 QRect DefaultHorizontalNodeGeometry::resizeHandleRect(NodeId const nodeId) const
 {
-    QSize size = _graphModel.nodeData<QSize>(nodeId, NodeRole::Size);
+    QSize size = _graphModel.nodeSize(nodeId);
 
     unsigned int rectSize = 7;
 
     return QRect(size.width() - _portSpasing, size.height() - _portSpasing, rectSize, rectSize);
 }
 
-QRectF DefaultHorizontalNodeGeometry::portTextRect(NodeId const nodeId,
-                                                   PortType const portType,
-                                                   PortIndex const portIndex) const
+void DefaultHorizontalNodeGeometry::invalidateLayout(NodeId const nodeId) const
 {
-    QString s;
-    if (_graphModel.portData<bool>(nodeId, portType, portIndex, PortRole::CaptionVisible)) {
-        s = _graphModel.portData<QString>(nodeId, portType, portIndex, PortRole::Caption);
-    } else {
-        auto portData = _graphModel.portData(nodeId, portType, portIndex, PortRole::DataType);
+    _layouts.erase(nodeId);
+}
+
+DefaultHorizontalNodeGeometry::NodeLayout &DefaultHorizontalNodeGeometry::measuredLayout(
+    NodeId const nodeId) const
+{
+    auto it = _layouts.find(nodeId);
+
+    if (it != _layouts.end())
+        return it->second;
+
+    NodeLayout &l = _layouts[nodeId];
+
+    if (_graphModel.nodeCaptionVisible(nodeId))
+        l.captionRect = _boldFontMetrics.boundingRect(_graphModel.nodeCaption(nodeId));
+
+    for (PortType const portType : {PortType::In, PortType::Out}) {
+        NodeLayout::Ports &ports = l.ports(portType);
+
+        size_t const n = _graphModel.portCount(nodeId, portType);
 
-        s = portData.value<NodeDataType>().name;
+        ports.ports.resize(n);
+
+        for (PortIndex portIndex = 0ul; portIndex < n; ++portIndex) {
+            QString const name = _graphModel.portLabel(nodeId, portType, portIndex);
+
+            ports.ports[portIndex].textRect = _fontMetrics.boundingRect(name);
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
+            ports.maxTextAdvance = std::max(unsigned(_fontMetrics.horizontalAdvance(name)),
+                                            ports.maxTextAdvance);
+#else
+            ports.maxTextAdvance = std::max(unsigned(_fontMetrics.width(name)),
+                                            ports.maxTextAdvance);
+#endif
+        }
     }
 
-    return _fontMetrics.boundingRect(s);
+    if (auto w = _graphModel.nodeWidget(nodeId)) {
+        l.hasWidget = true;
+        l.widgetExpanding = w->sizePolicy().verticalPolicy() & QSizePolicy::ExpandFlag;
+        l.widgetHeight = w->height();
+    }
+
+    return l;
 }
 
-unsigned int DefaultHorizontalNodeGeometry::maxVerticalPortsExtent(NodeId const nodeId) const
+DefaultHorizontalNodeGeometry::NodeLayout &DefaultHorizontalNodeGeometry::layout(
+    NodeId const nodeId) const
 {
-    PortCount nInPorts = _graphModel.nodeData<PortCount>(nodeId, NodeRole::InPortCount);
+    NodeLayout &l = measuredLayout(nodeId);
 
-    PortCount nOutPorts = _graphModel.nodeData<PortCount>(nodeId, NodeRole::OutPortCount);
+    QSize const size = _graphModel.nodeSize(nodeId);
 
-    unsigned int maxNumOfEntries = std::max(nInPorts, nOutPorts);
-    unsigned int step = _portSize + _portSpasing;
+    if (l.placed && l.size == size)
+        return l;
 
-    return step * maxNumOfEntries;
-}
+    l.placed = true;
+    l.size = size;
 
-unsigned int DefaultHorizontalNodeGeometry::maxPortsTextAdvance(NodeId const nodeId,
-                                                                PortType const portType) const
-{
-    unsigned int width = 0;
+    unsigned int const step = _portSize + _portSpasing;
 
-    size_t const n = _graphModel
-                         .nodeData(nodeId,
-                                   (portType == PortType::Out) ? NodeRole::OutPortCount
-                                                               : NodeRole::InPortCount)
-                         .toUInt();
+    for (PortType const portType : {PortType::In, PortType::Out}) {
+        double totalHeight = l.captionRect.height() + _portSpasing + step / 2.0;
 
-    for (PortIndex portIndex = 0ul; portIndex < n; ++portIndex) {
-        QString name;
+        for (PortLayout &port : l.ports(portType).ports) {
+            double const x = (portType == PortType::In) ? 0.0 : size.width();
 
-        if (_graphModel.portData<bool>(nodeId, portType, portIndex, PortRole::CaptionVisible)) {
-            name = _graphModel.portData<QString>(nodeId, portType, portIndex, PortRole::Caption);
-        } else {
-            NodeDataType portData = _graphModel.portData<NodeDataType>(nodeId,
-                                                                       portType,
-                                                                       portIndex,
-                                                                       PortRole::DataType);
+            port.position = QPointF(x, totalHeight);
+
+            double const textX = (portType == PortType::In)
+                                     ? _portSpasing
+                                     : size.width() - _portSpasing - port.textRect.width();
+
+            port.textPosition = QPointF(textX, totalHeight + port.textRect.height() / 4.0);
 
-            name = portData.name;
+            totalHeight += step;
         }
+    }
 
-#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
-        width = std::max(unsigned(_fontMetrics.horizontalAdvance(name)), width);
-#else
-        width = std::max(unsigned(_fontMetrics.width(name)), width);
-#endif
+    l.captionPosition = QPointF(0.5 * (size.width() - l.captionRect.width()),
+                                0.5 * _portSpasing + l.captionRect.height());
+
+    unsigned int captionHeight = l.captionRect.height();
+
+    if (l.hasWidget) {
+        // If the widget wants to use as much vertical space as possible,
+        // place it immediately after the caption.
+        if (l.widgetExpanding) {
+            l.widgetPosition = QPointF(2.0 * _portSpasing + l.in.maxTextAdvance, captionHeight);
+        } else {
+            l.widgetPosition = QPointF(2.0 * _portSpasing + l.in.maxTextAdvance,
+                                       (captionHeight + size.height() - l.widgetHeight) / 2.0);
+        }
+    } else {
+        l.widgetPosition = QPointF();
+    }
+
+    return l;
+}
+
+DefaultHorizontalNodeGeometry::PortLayout const &DefaultHorizontalNodeGeometry::portLayout(
+    NodeId const nodeId, PortType const portType, PortIndex const portIndex) const
+{
+    static PortLayout const none;
+
+    if (portType == PortType::None)
+        return none;
+
+    NodeLayout *l = &layout(nodeId);
+
+    // The model may add ports and reconnect to them before the scene gets
+    // around to `recomputeSize`.
+    if (portIndex >= l->ports(portType).ports.size()) {
+        invalidateLayout(nodeId);
+        l = &layout(nodeId);
+
+        if (portIndex >= l->ports(portType).ports.size())
+            return none;
     }
 
-    return width;
+    return l->ports(portType).ports[portIndex];
 }
 
 } // namespace QtNodes
@@ -1,8 +1,14 @@
 #include "DefaultNodePainter.hpp"
 
+#include <algorithm>
 #include <cmath>
+#include <vector>
 
 #include <QtCore/QMargins>
+#include <QtGui/QImage>
+#include <QtGui/QPixmapCache>
+#include <QtWidgets/QStyleOptionGraphicsItem>
+#include <QtWidgets/qdrawutil.h>
 
 #include "AbstractGraphModel.hpp"
 #include "AbstractNodeGeometry.hpp"
@@ -15,38 +21,154 @@
 
 namespace QtNodes {
 
+namespace {
+
+/// The nodes used to carry a QGraphicsDropShadowEffect with these settings.
+constexpr int ShadowOffset = 4;
+
+constexpr int ShadowBlurRadius = 20;
+
+/// How far the blurred edge reaches on either side of the node boundary.
+constexpr int ShadowSpread = ShadowBlurRadius / 2;
+
+/// Nine-patch margins, each corner holds the whole blurred edge.
+constexpr int ShadowMargin = 2 * ShadowSpread;
+
+QPixmap shadowPixmap(QColor const &color)
+{
+    QString const key = QStringLiteral("QtNodes::NodeShadow:%1").arg(color.rgba(), 8, 16);
+
+    QPixmap pixmap;
+
+    if (QPixmapCache::find(key, &pixmap))
+        return pixmap;
+
+    // The single middle row and column are the ones stretched along the node.
+    int const side = 2 * ShadowMargin + 1;
+
+    QImage image(side, side, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+
+    {
+        QPainter p(&image);
+        p.setRenderHint(QPainter::Antialiasing);
+        p.setPen(Qt::NoPen);
+        p.setBrush(Qt::black);
+        p.drawRoundedRect(QRectF(ShadowSpread,
+                                 ShadowSpread,
+                                 side - 2 * ShadowSpread,
+                                 side - 2 * ShadowSpread),
+                          3.0,
+                          3.0);
+    }
+
+    std::vector<int> alpha(side * side);
+    std::vector<int> buffer(side * side);
+
+    for (int y = 0; y < side; ++y) {
+        for (int x = 0; x < side; ++x) {
+            alpha[y * side + x] = qAlpha(image.pixel(x, y));
+        }
+    }
+
+    // Three box blur passes come close enough to a gaussian.
+    int const r = std::max(1, ShadowSpread / 3);
+
+    auto boxBlur = [side, r](std::vector<int> const &src, std::vector<int> &dst, bool horizontal) {
+        for (int line = 0; line < side; ++line) {
+            for (int i = 0; i < side; ++i) {
+                int sum = 0;
+
+                for (int k = std::max(0, i - r); k <= std::min(side - 1, i + r); ++k) {
+                    sum += horizontal ? src[line * side + k] : src[k * side + line];
+                }
+
+                (horizontal ? dst[line * side + i] : dst[i * side + line]) = sum / (2 * r + 1);
+            }
+        }
+    };
+
+    for (int pass = 0; pass < 3; ++pass) {
+        boxBlur(alpha, buffer, true);
+        boxBlur(buffer, alpha, false);
+    }
+
+    for (int y = 0; y < side; ++y) {
+        for (int x = 0; x < side; ++x) {
+            int const a = alpha[y * side + x] * color.alpha() / 255;
+
+            image.setPixel(x, y, qPremultiply(qRgba(color.red(), color.green(), color.blue(), a)));
+        }
+    }
+
+    pixmap = QPixmap::fromImage(image);
+
+    QPixmapCache::insert(key, pixmap);
+
+    return pixmap;
+}
+
+} // namespace
+
 void DefaultNodePainter::paint(QPainter *painter, NodeGraphicsObject &ngo) const
 {
     // TODO?
     //AbstractNodeGeometry & geometry = ngo.nodeScene()->nodeGeometry();
     //geometry.recomputeSizeIfFontChanged(painter->font());
 
-    drawNodeRect(painter, ngo);
+    ngo.graphModel().fillRenderInfo(ngo.nodeId(), _renderInfo);
 
-    drawConnectionPoints(painter, ngo);
+    qreal const scale = QStyleOptionGraphicsItem::levelOfDetailFromTransform(
+        painter->worldTransform());
 
-    drawFilledConnectionPoints(painter, ngo);
+    switch (ngo.nodeScene()->levelOfDetail(scale)) {
+    case LevelOfDetail::Minimal:
+        painter->setRenderHint(QPainter::Antialiasing, false);
+        drawFlatNodeRect(painter, ngo, _renderInfo);
+        return;
+
+    case LevelOfDetail::Reduced:
+        drawFlatNodeRect(painter, ngo, _renderInfo);
+        drawNodeCaption(painter, ngo, _renderInfo);
+        return;
 
-    drawNodeCaption(painter, ngo);
+    case LevelOfDetail::Full:
+        break;
+    }
 
-    drawEntryLabels(painter, ngo);
+    drawShadow(painter, _renderInfo);
+
+    drawNodeRect(painter, ngo, _renderInfo);
+
+    drawConnectionPoints(painter, ngo, _renderInfo);
+
+    drawFilledConnectionPoints(painter, ngo, _renderInfo);
+
+    drawNodeCaption(painter, ngo, _renderInfo);
+
+    drawEntryLabels(painter, ngo, _renderInfo);
 
     drawResizeRect(painter, ngo);
 }
 
-void DefaultNodePainter::drawNodeRect(QPainter *painter, NodeGraphicsObject &ngo) const
+void DefaultNodePainter::drawShadow(QPainter *painter, NodeRenderInfo const &info) const
 {
-    AbstractGraphModel &model = ngo.graphModel();
-
-    NodeId const nodeId = ngo.nodeId();
+    QRect const target = QRect(QPoint(0, 0), info.size)
+                             .translated(ShadowOffset, ShadowOffset)
+                             .adjusted(-ShadowSpread, -ShadowSpread, ShadowSpread, ShadowSpread);
 
-    AbstractNodeGeometry &geometry = ngo.nodeScene()->nodeGeometry();
+    QMargins const margins(ShadowMargin, ShadowMargin, ShadowMargin, ShadowMargin);
 
-    QSize size = geometry.size(nodeId);
+    qDrawBorderPixmap(painter, target, margins, shadowPixmap(info.style->ShadowColor));
+}
 
-    QJsonDocument json = QJsonDocument::fromVariant(model.nodeData(nodeId, NodeRole::Style));
+void DefaultNodePainter::drawNodeRect(QPainter *painter,
+                                      NodeGraphicsObject &ngo,
+                                      NodeRenderInfo const &info) const
+{
+    QSize const &size = info.size;
 
-    NodeStyle nodeStyle(json.object());
+    NodeStyle const &nodeStyle = *info.style;
 
     auto color = ngo.isSelected() ? nodeStyle.SelectedBoundaryColor : nodeStyle.NormalBoundaryColor;
 
@@ -74,14 +196,29 @@ void DefaultNodePainter::drawNodeRect(QPainter *painter, NodeGraphicsObject &ngo
     painter->drawRoundedRect(boundary, radius, radius);
 }
 
-void DefaultNodePainter::drawConnectionPoints(QPainter *painter, NodeGraphicsObject &ngo) const
+void DefaultNodePainter::drawFlatNodeRect(QPainter *painter,
+                                          NodeGraphicsObject &ngo,
+                                          NodeRenderInfo const &info) const
+{
+    NodeStyle const &nodeStyle = *info.style;
+
+    auto color = ngo.isSelected() ? nodeStyle.SelectedBoundaryColor : nodeStyle.NormalBoundaryColor;
+
+    painter->setPen(QPen(color, nodeStyle.PenWidth));
+    painter->setBrush(nodeStyle.GradientColor1);
+
+    painter->drawRect(QRectF(0, 0, info.size.width(), info.size.height()));
+}
+
+void DefaultNodePainter::drawConnectionPoints(QPainter *painter,
+                                              NodeGraphicsObject &ngo,
+                                              NodeRenderInfo const &info) const
 {
     AbstractGraphModel &model = ngo.graphModel();
     NodeId const nodeId = ngo.nodeId();
     AbstractNodeGeometry &geometry = ngo.nodeScene()->nodeGeometry();
 
-    QJsonDocument json = QJsonDocument::fromVariant(model.nodeData(nodeId, NodeRole::Style));
-    NodeStyle nodeStyle(json.object());
+    NodeStyle const &nodeStyle = *info.style;
 
     auto const &connectionStyle = StyleCollection::connectionStyle();
 
@@ -89,17 +226,14 @@ void DefaultNodePainter::drawConnectionPoints(QPainter *painter, NodeGraphicsObj
     auto reducedDiameter = diameter * 0.6;
 
     for (PortType portType : {PortType::Out, PortType::In}) {
-        size_t const n = model
-                             .nodeData(nodeId,
-                                       (portType == PortType::Out) ? NodeRole::OutPortCount
-                                                                   : NodeRole::InPortCount)
-                             .toUInt();
+        auto const &ports = info.ports(portType);
+
+        size_t const n = ports.size();
 
         for (PortIndex portIndex = 0; portIndex < n; ++portIndex) {
             QPointF p = geometry.portPosition(nodeId, portType, portIndex);
 
-            auto const &dataType = model.portData(nodeId, portType, portIndex, PortRole::DataType)
-                                       .value<NodeDataType>();
+            DataTypeHandle const typeHandle = ports[portIndex].typeHandle;
 
             double r = 1.0;
 
@@ -132,7 +266,7 @@ void DefaultNodePainter::drawConnectionPoints(QPainter *painter, NodeGraphicsObj
             }
 
             if (connectionStyle.useDataDefinedColors()) {
-                painter->setBrush(connectionStyle.normalColor(dataType.id));
+                painter->setBrush(connectionStyle.normalColor(typeHandle));
             } else {
                 painter->setBrush(nodeStyle.ConnectionPointColor);
             }
@@ -146,37 +280,29 @@ void DefaultNodePainter::drawConnectionPoints(QPainter *painter, NodeGraphicsObj
     }
 }
 
-void DefaultNodePainter::drawFilledConnectionPoints(QPainter *painter, NodeGraphicsObject &ngo) const
+void DefaultNodePainter::drawFilledConnectionPoints(QPainter *painter,
+                                                    NodeGraphicsObject &ngo,
+                                                    NodeRenderInfo const &info) const
 {
-    AbstractGraphModel &model = ngo.graphModel();
     NodeId const nodeId = ngo.nodeId();
     AbstractNodeGeometry &geometry = ngo.nodeScene()->nodeGeometry();
 
-    QJsonDocument json = QJsonDocument::fromVariant(model.nodeData(nodeId, NodeRole::Style));
-    NodeStyle nodeStyle(json.object());
+    NodeStyle const &nodeStyle = *info.style;
 
     auto diameter = nodeStyle.ConnectionPointDiameter;
 
     for (PortType portType : {PortType::Out, PortType::In}) {
-        size_t const n = model
-                             .nodeData(nodeId,
-                                       (portType == PortType::Out) ? NodeRole::OutPortCount
-                                                                   : NodeRole::InPortCount)
-                             .toUInt();
-
-        for (PortIndex portIndex = 0; portIndex < n; ++portIndex) {
-            QPointF p = geometry.portPosition(nodeId, portType, portIndex);
+        auto const &ports = info.ports(portType);
 
-            auto const &connected = model.connections(nodeId, portType, portIndex);
+        size_t const n = ports.size();
 
-            if (!connected.empty()) {
-                auto const &dataType = model
-                                           .portData(nodeId, portType, portIndex, PortRole::DataType)
-                                           .value<NodeDataType>();
+        for (PortIndex portIndex = 0; portIndex < n; ++portIndex) {
+            if (ports[portIndex].connected) {
+                QPointF p = geometry.portPosition(nodeId, portType, portIndex);
 
                 auto const &connectionStyle = StyleCollection::connectionStyle();
                 if (connectionStyle.useDataDefinedColors()) {
-                    QColor const c = connectionStyle.normalColor(dataType.id);
+                    QColor const c = connectionStyle.normalColor(ports[portIndex].typeHandle);
                     painter->setPen(c);
                     painter->setBrush(c);
                 } else {
@@ -190,24 +316,24 @@ void DefaultNodePainter::drawFilledConnectionPoints(QPainter *painter, NodeGraph
     }
 }
 
-void DefaultNodePainter::drawNodeCaption(QPainter *painter, NodeGraphicsObject &ngo) const
+void DefaultNodePainter::drawNodeCaption(QPainter *painter,
+                                         NodeGraphicsObject &ngo,
+                                         NodeRenderInfo const &info) const
 {
-    AbstractGraphModel &model = ngo.graphModel();
     NodeId const nodeId = ngo.nodeId();
     AbstractNodeGeometry &geometry = ngo.nodeScene()->nodeGeometry();
 
-    if (!model.nodeData(nodeId, NodeRole::CaptionVisible).toBool())
+    if (!info.captionVisible)
         return;
 
-    QString const name = model.nodeData(nodeId, NodeRole::Caption).toString();
+    QString const &name = info.caption;
 
     QFont f = painter->font();
     f.setBold(true);
 
     QPointF position = geometry.captionPosition(nodeId);
 
-    QJsonDocument json = QJsonDocument::fromVariant(model.nodeData(nodeId, NodeRole::Style));
-    NodeStyle nodeStyle(json.object());
+    NodeStyle const &nodeStyle = *info.style;
 
     painter->setFont(f);
     painter->setPen(nodeStyle.FontColor);
@@ -217,42 +343,29 @@ void DefaultNodePainter::drawNodeCaption(QPainter *painter, NodeGraphicsObject &
     painter->setFont(f);
 }
 
-void DefaultNodePainter::drawEntryLabels(QPainter *painter, NodeGraphicsObject &ngo) const
+void DefaultNodePainter::drawEntryLabels(QPainter *painter,
+                                         NodeGraphicsObject &ngo,
+                                         NodeRenderInfo const &info) const
 {
-    AbstractGraphModel &model = ngo.graphModel();
     NodeId const nodeId = ngo.nodeId();
     AbstractNodeGeometry &geometry = ngo.nodeScene()->nodeGeometry();
 
-    QJsonDocument json = QJsonDocument::fromVariant(model.nodeData(nodeId, NodeRole::Style));
-    NodeStyle nodeStyle(json.object());
+    NodeStyle const &nodeStyle = *info.style;
 
     for (PortType portType : {PortType::Out, PortType::In}) {
-        unsigned int n = model.nodeData<unsigned int>(nodeId,
-                                                      (portType == PortType::Out)
-                                                          ? NodeRole::OutPortCount
-                                                          : NodeRole::InPortCount);
+        auto const &ports = info.ports(portType);
 
-        for (PortIndex portIndex = 0; portIndex < n; ++portIndex) {
-            auto const &connected = model.connections(nodeId, portType, portIndex);
+        size_t const n = ports.size();
 
+        for (PortIndex portIndex = 0; portIndex < n; ++portIndex) {
             QPointF p = geometry.portTextPosition(nodeId, portType, portIndex);
 
-            if (connected.empty())
+            if (!ports[portIndex].connected)
                 painter->setPen(nodeStyle.FontColorFaded);
             else
                 painter->setPen(nodeStyle.FontColor);
 
-            QString s;
-
-            if (model.portData<bool>(nodeId, portType, portIndex, PortRole::CaptionVisible)) {
-                s = model.portData<QString>(nodeId, portType, portIndex, PortRole::Caption);
-            } else {
-                auto portData = model.portData(nodeId, portType, portIndex, PortRole::DataType);
-
-                s = portData.value<NodeDataType>().name;
-            }
-
-            painter->drawText(p, s);
+            painter->drawText(p, ports[portIndex].label);
         }
     }
 }
@@ -25,34 +25,37 @@ DefaultVerticalNodeGeometry::DefaultVerticalNodeGeometry(AbstractGraphModel &gra
 
 QSize DefaultVerticalNodeGeometry::size(NodeId const nodeId) const
 {
-    return _graphModel.nodeData<QSize>(nodeId, NodeRole::Size);
+    return _graphModel.nodeSize(nodeId);
 }
 
 void DefaultVerticalNodeGeometry::recomputeSize(NodeId const nodeId) const
 {
+    // Ports, caption or widget have changed.
+    invalidateLayout(nodeId);
+
+    NodeLayout const &l = measuredLayout(nodeId);
+
     unsigned int height = _portSpasing; // maxHorizontalPortsExtent(nodeId);
 
-    if (auto w = _graphModel.nodeData<QWidget *>(nodeId, NodeRole::Widget)) {
+    if (auto w = _graphModel.nodeWidget(nodeId)) {
         height = std::max(height, static_cast<unsigned int>(w->height()));
     }
 
-    QRectF const capRect = captionRect(nodeId);
-
-    height += capRect.height();
+    height += l.captionRect.height();
 
     height += _portSpasing;
     height += _portSpasing;
 
-    PortCount nInPorts = _graphModel.nodeData<PortCount>(nodeId, NodeRole::InPortCount);
-    PortCount nOutPorts = _graphModel.nodeData<PortCount>(nodeId, NodeRole::OutPortCount);
+    PortCount nInPorts = l.in.ports.size();
+    PortCount nOutPorts = l.out.ports.size();
 
     // Adding double step (top and bottom) to reserve space for port captions.
 
-    height += portCaptionsHeight(nodeId, PortType::In);
-    height += portCaptionsHeight(nodeId, PortType::Out);
+    height += l.in.captionsHeight;
+    height += l.out.captionsHeight;
 
-    unsigned int inPortWidth = maxPortsTextAdvance(nodeId, PortType::In);
-    unsigned int outPortWidth = maxPortsTextAdvance(nodeId, PortType::Out);
+    unsigned int inPortWidth = l.in.maxTextAdvance;
+    unsigned int outPortWidth = l.out.maxTextAdvance;
 
     unsigned int totalInPortsWidth = nInPorts > 0
                                          ? inPortWidth * nInPorts + _portSpasing * (nInPorts - 1)
@@ -64,11 +67,11 @@ void DefaultVerticalNodeGeometry::recomputeSize(NodeId const nodeId) const
 
     unsigned int width = std::max(totalInPortsWidth, totalOutPortsWidth);
 
-    if (auto w = _graphModel.nodeData<QWidget *>(nodeId, NodeRole::Widget)) {
+    if (auto w = _graphModel.nodeWidget(nodeId)) {
         width = std::max(width, static_cast<unsigned int>(w->width()));
     }
 
-    width = std::max(width, static_cast<unsigned int>(capRect.width()));
+    width = std::max(width, static_cast<unsigned int>(l.captionRect.width()));
 
     width += _portSpasing;
     width += _portSpasing;
@@ -82,219 +85,175 @@ QPointF DefaultVerticalNodeGeometry::portPosition(NodeId const nodeId,
                                                   PortType const portType,
                                                   PortIndex const portIndex) const
 {
-    QPointF result;
-
-    QSize size = _graphModel.nodeData<QSize>(nodeId, NodeRole::Size);
-
-    switch (portType) {
-    case PortType::In: {
-        unsigned int inPortWidth = maxPortsTextAdvance(nodeId, PortType::In) + _portSpasing;
-
-        PortCount nInPorts = _graphModel.nodeData<PortCount>(nodeId, NodeRole::InPortCount);
-
-        double x = (size.width() - (nInPorts - 1) * inPortWidth) / 2.0 + portIndex * inPortWidth;
-
-        double y = 0.0;
-
-        result = QPointF(x, y);
-
-        break;
-    }
-
-    case PortType::Out: {
-        unsigned int outPortWidth = maxPortsTextAdvance(nodeId, PortType::Out) + _portSpasing;
-        PortCount nOutPorts = _graphModel.nodeData<PortCount>(nodeId, NodeRole::OutPortCount);
-
-        double x = (size.width() - (nOutPorts - 1) * outPortWidth) / 2.0 + portIndex * outPortWidth;
-
-        double y = size.height();
-
-        result = QPointF(x, y);
-
-        break;
-    }
-
-    default:
-        break;
-    }
-
-    return result;
+    return portLayout(nodeId, portType, portIndex).position;
 }
 
 QPointF DefaultVerticalNodeGeometry::portTextPosition(NodeId const nodeId,
                                                       PortType const portType,
                                                       PortIndex const portIndex) const
 {
-    QPointF p = portPosition(nodeId, portType, portIndex);
-
-    QRectF rect = portTextRect(nodeId, portType, portIndex);
-
-    p.setX(p.x() - rect.width() / 2.0);
-
-    QSize size = _graphModel.nodeData<QSize>(nodeId, NodeRole::Size);
-
-    switch (portType) {
-    case PortType::In:
-        p.setY(5.0 + rect.height());
-        break;
-
-    case PortType::Out:
-        p.setY(size.height() - 5.0);
-        break;
-
-    default:
-        break;
-    }
-
-    return p;
+    return portLayout(nodeId, portType, portIndex).textPosition;
 }
 
 QRectF DefaultVerticalNodeGeometry::captionRect(NodeId const nodeId) const
 {
-    if (!_graphModel.nodeData<bool>(nodeId, NodeRole::CaptionVisible))
-        return QRect();
-
-    QString name = _graphModel.nodeData<QString>(nodeId, NodeRole::Caption);
-
-    return _boldFontMetrics.boundingRect(name);
+    return measuredLayout(nodeId).captionRect;
 }
 
 QPointF DefaultVerticalNodeGeometry::captionPosition(NodeId const nodeId) const
 {
-    QSize size = _graphModel.nodeData<QSize>(nodeId, NodeRole::Size);
-
-    unsigned int step = portCaptionsHeight(nodeId, PortType::In);
-    step += _portSpasing;
-
-    auto rect = captionRect(nodeId);
-
-    return QPointF(0.5 * (size.width() - rect.width()), step + rect.height());
+    return layout(nodeId).captionPosition;
 }
 
 QPointF DefaultVerticalNodeGeometry::widgetPosition(NodeId const nodeId) const
 {
-    QSize size = _graphModel.nodeData<QSize>(nodeId, NodeRole::Size);
-
-    unsigned int captionHeight = captionRect(nodeId).height();
-
-    if (auto w = _graphModel.nodeData<QWidget *>(nodeId, NodeRole::Widget)) {
-        // If the widget wants to use as much vertical space as possible,
-        // place it immediately after the caption.
-        if (w->sizePolicy().verticalPolicy() & QSizePolicy::ExpandFlag) {
-            return QPointF(_portSpasing + maxPortsTextAdvance(nodeId, PortType::In), captionHeight);
-        } else {
-            return QPointF(_portSpasing + maxPortsTextAdvance(nodeId, PortType::In),
-                           (captionHeight + size.height() - w->height()) / 2.0);
-        }
-    }
-    return QPointF();
+    return layout(nodeId).widgetPosition;
 }
 
 QRect DefaultVerticalNodeGeometry::resizeHandleRect(NodeId const nodeId) const
 {
-    QSize size = _graphModel.nodeData<QSize>(nodeId, NodeRole::Size);
+    QSize size = _graphModel.nodeSize(nodeId);
 
     unsigned int rectSize = 7;
 
     return QRect(size.width() - rectSize, size.height() - rectSize, rectSize, rectSize);
 }
 
-QRectF DefaultVerticalNodeGeometry::portTextRect(NodeId const nodeId,
-                                                 PortType const portType,
-                                                 PortIndex const portIndex) const
+void DefaultVerticalNodeGeometry::invalidateLayout(NodeId const nodeId) const
 {
-    QString s;
-    if (_graphModel.portData<bool>(nodeId, portType, portIndex, PortRole::CaptionVisible)) {
-        s = _graphModel.portData<QString>(nodeId, portType, portIndex, PortRole::Caption);
-    } else {
-        auto portData = _graphModel.portData(nodeId, portType, portIndex, PortRole::DataType);
-
-        s = portData.value<NodeDataType>().name;
-    }
-
-    return _fontMetrics.boundingRect(s);
+    _layouts.erase(nodeId);
 }
 
-unsigned int DefaultVerticalNodeGeometry::maxHorizontalPortsExtent(NodeId const nodeId) const
+DefaultVerticalNodeGeometry::NodeLayout &DefaultVerticalNodeGeometry::measuredLayout(
+    NodeId const nodeId) const
 {
-    PortCount nInPorts = _graphModel.nodeData<PortCount>(nodeId, NodeRole::InPortCount);
+    auto it = _layouts.find(nodeId);
 
-    PortCount nOutPorts = _graphModel.nodeData<PortCount>(nodeId, NodeRole::OutPortCount);
+    if (it != _layouts.end())
+        return it->second;
 
-    unsigned int maxNumOfEntries = std::max(nInPorts, nOutPorts);
-    unsigned int step = _portSize + _portSpasing;
+    NodeLayout &l = _layouts[nodeId];
 
-    return step * maxNumOfEntries;
-}
+    if (_graphModel.nodeCaptionVisible(nodeId))
+        l.captionRect = _boldFontMetrics.boundingRect(_graphModel.nodeCaption(nodeId));
 
-unsigned int DefaultVerticalNodeGeometry::maxPortsTextAdvance(NodeId const nodeId,
-                                                              PortType const portType) const
-{
-    unsigned int width = 0;
+    for (PortType const portType : {PortType::In, PortType::Out}) {
+        NodeLayout::Ports &ports = l.ports(portType);
 
-    size_t const n = _graphModel
-                         .nodeData(nodeId,
-                                   (portType == PortType::Out) ? NodeRole::OutPortCount
-                                                               : NodeRole::InPortCount)
-                         .toUInt();
+        size_t const n = _graphModel.portCount(nodeId, portType);
 
-    for (PortIndex portIndex = 0ul; portIndex < n; ++portIndex) {
-        QString name;
+        ports.ports.resize(n);
 
-        if (_graphModel.portData<bool>(nodeId, portType, portIndex, PortRole::CaptionVisible)) {
-            name = _graphModel.portData<QString>(nodeId, portType, portIndex, PortRole::Caption);
-        } else {
-            NodeDataType portData = _graphModel.portData<NodeDataType>(nodeId,
-                                                                       portType,
-                                                                       portIndex,
-                                                                       PortRole::DataType);
+        for (PortIndex portIndex = 0ul; portIndex < n; ++portIndex) {
+            QString const name = _graphModel.portLabel(nodeId, portType, portIndex);
 
-            name = portData.name;
-        }
+            ports.ports[portIndex].textRect = _fontMetrics.boundingRect(name);
 
 #if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
-        width = std::max(unsigned(_fontMetrics.horizontalAdvance(name)), width);
+            ports.maxTextAdvance = std::max(unsigned(_fontMetrics.horizontalAdvance(name)),
+                                            ports.maxTextAdvance);
 #else
-        width = std::max(unsigned(_fontMetrics.width(name)), width);
+            ports.maxTextAdvance = std::max(unsigned(_fontMetrics.width(name)),
+                                            ports.maxTextAdvance);
 #endif
+
+            if (ports.captionsHeight == 0
+                && _graphModel.portCaptionVisible(nodeId, portType, portIndex)) {
+                ports.captionsHeight = _portSpasing;
+            }
+        }
     }
 
-    return width;
+    if (auto w = _graphModel.nodeWidget(nodeId)) {
+        l.hasWidget = true;
+        l.widgetExpanding = w->sizePolicy().verticalPolicy() & QSizePolicy::ExpandFlag;
+        l.widgetHeight = w->height();
+    }
+
+    return l;
 }
 
-unsigned int DefaultVerticalNodeGeometry::portCaptionsHeight(NodeId const nodeId,
-                                                             PortType const portType) const
+DefaultVerticalNodeGeometry::NodeLayout &DefaultVerticalNodeGeometry::layout(
+    NodeId const nodeId) const
 {
-    unsigned int h = 0;
-
-    switch (portType) {
-    case PortType::In: {
-        PortCount nInPorts = _graphModel.nodeData<PortCount>(nodeId, NodeRole::InPortCount);
-        for (PortIndex i = 0; i < nInPorts; ++i) {
-            if (_graphModel.portData<bool>(nodeId, PortType::In, i, PortRole::CaptionVisible)) {
-                h += _portSpasing;
-                break;
-            }
+    NodeLayout &l = measuredLayout(nodeId);
+
+    QSize const size = _graphModel.nodeSize(nodeId);
+
+    if (l.placed && l.size == size)
+        return l;
+
+    l.placed = true;
+    l.size = size;
+
+    for (PortType const portType : {PortType::In, PortType::Out}) {
+        NodeLayout::Ports &ports = l.ports(portType);
+
+        unsigned int const portWidth = ports.maxTextAdvance + _portSpasing;
+
+        PortCount const n = ports.ports.size();
+
+        double const y = (portType == PortType::In) ? 0.0 : size.height();
+
+        for (PortIndex portIndex = 0; portIndex < n; ++portIndex) {
+            PortLayout &port = ports.ports[portIndex];
+
+            double const x = (size.width() - (n - 1) * portWidth) / 2.0 + portIndex * portWidth;
+
+            port.position = QPointF(x, y);
+
+            double const textY = (portType == PortType::In) ? 5.0 + port.textRect.height()
+                                                            : size.height() - 5.0;
+
+            port.textPosition = QPointF(x - port.textRect.width() / 2.0, textY);
         }
-        break;
     }
 
-    case PortType::Out: {
-        PortCount nOutPorts = _graphModel.nodeData<PortCount>(nodeId, NodeRole::OutPortCount);
-        for (PortIndex i = 0; i < nOutPorts; ++i) {
-            if (_graphModel.portData<bool>(nodeId, PortType::Out, i, PortRole::CaptionVisible)) {
-                h += _portSpasing;
-                break;
-            }
+    unsigned int step = l.in.captionsHeight;
+    step += _portSpasing;
+
+    l.captionPosition = QPointF(0.5 * (size.width() - l.captionRect.width()),
+                                step + l.captionRect.height());
+
+    unsigned int captionHeight = l.captionRect.height();
+
+    if (l.hasWidget) {
+        // If the widget wants to use as much vertical space as possible,
+        // place it immediately after the caption.
+        if (l.widgetExpanding) {
+            l.widgetPosition = QPointF(_portSpasing + l.in.maxTextAdvance, captionHeight);
+        } else {
+            l.widgetPosition = QPointF(_portSpasing + l.in.maxTextAdvance,
+                                       (captionHeight + size.height() - l.widgetHeight) / 2.0);
         }
-        break;
+    } else {
+        l.widgetPosition = QPointF();
     }
 
-    default:
-        break;
+    return l;
+}
+
+DefaultVerticalNodeGeometry::PortLayout const &DefaultVerticalNodeGeometry::portLayout(
+    NodeId const nodeId, PortType const portType, PortIndex const portIndex) const
+{
+    static PortLayout const none;
+
+    if (portType == PortType::None)
+        return none;
+
+    NodeLayout *l = &layout(nodeId);
+
+    // The model may add ports and reconnect to them before the scene gets
+    // around to `recomputeSize`.
+    if (portIndex >= l->ports(portType).ports.size()) {
+        invalidateLayout(nodeId);
+        l = &layout(nodeId);
+
+        if (portIndex >= l->ports(portType).ports.size())
+            return none;
     }
 
-    return h;
+    return l->ports(portType).ports[portIndex];
 }
 
 } // namespace QtNodes
@@ -344,32 +344,66 @@ void GraphicsView::mouseMoveEvent(QMouseEvent *event)
     }
 }
 
+namespace {
+
+constexpr double FineGridStep = 15.0;
+constexpr double CoarseGridStep = 150.0;
+
+/// Above this tile edge in device pixels the grid lines are drawn directly.
+constexpr int MaxGridTileSize = 1024;
+
+} // namespace
+
 void GraphicsView::drawBackground(QPainter *painter, const QRectF &r)
 {
     QGraphicsView::drawBackground(painter, r);
 
+    QTransform const t = painter->worldTransform();
+
+    // Device pixels per scene unit.
+    qreal const deviceScale = std::sqrt(t.m11() * t.m11() + t.m12() * t.m12())
+                              * painter->device()->devicePixelRatioF();
+
+    if (std::round(CoarseGridStep * deviceScale) <= MaxGridTileSize) {
+        QPixmap const &tile = gridTile(deviceScale);
+
+        // The tile covers exactly one coarse cell and is anchored at the scene
+        // origin, so the pattern lines up with the old grid lines.
+        qreal const unitsPerPixel = CoarseGridStep / tile.width();
+
+        QBrush brush(tile);
+        brush.setTransform(QTransform::fromScale(unitsPerPixel, unitsPerPixel));
+
+        painter->save();
+        painter->setBrushOrigin(0, 0);
+        painter->fillRect(r, brush);
+        painter->restore();
+
+        return;
+    }
+
+    // Zoomed in too far for a tile, only the lines crossing `r` are drawn.
     auto drawGrid = [&](double gridStep) {
-        QRect windowRect = rect();
-        QPointF tl = mapToScene(windowRect.topLeft());
-        QPointF br = mapToScene(windowRect.bottomRight());
+        double left = std::floor(r.left() / gridStep);
+        double right = std::ceil(r.right() / gridStep);
+        double top = std::floor(r.top() / gridStep);
+        double bottom = std::ceil(r.bottom() / gridStep);
 
-        double left = std::floor(tl.x() / gridStep - 0.5);
-        double right = std::floor(br.x() / gridStep + 1.0);
-        double bottom = std::floor(tl.y() / gridStep - 0.5);
-        double top = std::floor(br.y() / gridStep + 1.0);
+        QVector<QLineF> lines;
 
         // vertical lines
         for (int xi = int(left); xi <= int(right); ++xi) {
-            QLineF line(xi * gridStep, bottom * gridStep, xi * gridStep, top * gridStep);
-
-            painter->drawLine(line);
+            lines.push_back(
+                QLineF(xi * gridStep, top * gridStep, xi * gridStep, bottom * gridStep));
         }
 
         // horizontal lines
-        for (int yi = int(bottom); yi <= int(top); ++yi) {
-            QLineF line(left * gridStep, yi * gridStep, right * gridStep, yi * gridStep);
-            painter->drawLine(line);
+        for (int yi = int(top); yi <= int(bottom); ++yi) {
+            lines.push_back(
+                QLineF(left * gridStep, yi * gridStep, right * gridStep, yi * gridStep));
         }
+
+        painter->drawLines(lines);
     };
 
     auto const &flowViewStyle = StyleCollection::flowViewStyle();
@@ -377,12 +411,64 @@ void GraphicsView::drawBackground(QPainter *painter, const QRectF &r)
     QPen pfine(flowViewStyle.FineGridColor, 1.0);
 
     painter->setPen(pfine);
-    drawGrid(15);
+    drawGrid(FineGridStep);
 
     QPen p(flowViewStyle.CoarseGridColor, 1.0);
 
     painter->setPen(p);
-    drawGrid(150);
+    drawGrid(CoarseGridStep);
+}
+
+QPixmap const &GraphicsView::gridTile(qreal deviceScale)
+{
+    auto const &flowViewStyle = StyleCollection::flowViewStyle();
+
+    QRgb const fineColor = flowViewStyle.FineGridColor.rgba();
+    QRgb const coarseColor = flowViewStyle.CoarseGridColor.rgba();
+
+    if (!_gridTile.isNull() && qFuzzyCompare(_gridTileScale, deviceScale)
+        && _gridTileColors[0] == fineColor && _gridTileColors[1] == coarseColor)
+        return _gridTile;
+
+    _gridTileScale = deviceScale;
+    _gridTileColors[0] = fineColor;
+    _gridTileColors[1] = coarseColor;
+
+    // A whole number of pixels, otherwise the seams drift while panning.
+    int const size = std::max(1, qRound(CoarseGridStep * deviceScale));
+
+    qreal const pixelsPerUnit = size / CoarseGridStep;
+
+    // Same width as the 1.0 scene unit pens the lines used to be drawn with.
+    qreal const lineWidth = pixelsPerUnit;
+
+    _gridTile = QPixmap(size, size);
+    _gridTile.fill(Qt::transparent);
+
+    QPainter painter(&_gridTile);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(Qt::NoPen);
+
+    int const fineLines = qRound(CoarseGridStep / FineGridStep);
+
+    painter.setBrush(QColor::fromRgba(fineColor));
+
+    for (int i = 1; i < fineLines; ++i) {
+        qreal const pos = i * FineGridStep * pixelsPerUnit;
+
+        painter.drawRect(QRectF(pos - lineWidth / 2.0, 0.0, lineWidth, size));
+        painter.drawRect(QRectF(0.0, pos - lineWidth / 2.0, size, lineWidth));
+    }
+
+    // Each coarse line is split between the edges of two neighbouring tiles.
+    painter.setBrush(QColor::fromRgba(coarseColor));
+
+    painter.drawRect(QRectF(0.0, 0.0, lineWidth / 2.0, size));
+    painter.drawRect(QRectF(size - lineWidth / 2.0, 0.0, lineWidth / 2.0, size));
+    painter.drawRect(QRectF(0.0, 0.0, size, lineWidth / 2.0));
+    painter.drawRect(QRectF(0.0, size - lineWidth / 2.0, size, lineWidth / 2.0));
+
+    return _gridTile;
 }
 
 void GraphicsView::showEvent(QShowEvent *event)
@@ -392,6 +478,18 @@ void GraphicsView::showEvent(QShowEvent *event)
     centerScene();
 }
 
+void GraphicsView::paintEvent(QPaintEvent *event)
+{
+    // Scrolling, zooming and resizing all end up here, so the scene learns
+    // about every change of the visible area before the items are drawn.
+    if (auto scene = nodeScene()) {
+        scene->setVisibleSceneRect(mapToScene(viewport()->rect()).boundingRect());
+        scene->setViewScale(transform().m11());
+    }
+
+    QGraphicsView::paintEvent(event);
+}
+
 BasicGraphicsScene *GraphicsView::nodeScene()
 {
     return dynamic_cast<BasicGraphicsScene *>(scene());
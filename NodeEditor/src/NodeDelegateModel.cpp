@@ -2,12 +2,36 @@
 
 #include "StyleCollection.hpp"
 
+#include <algorithm>
+
 namespace QtNodes {
 
 NodeDelegateModel::NodeDelegateModel()
     : _nodeStyle(StyleCollection::nodeStyle())
+    , _moreInDataPending(false)
 {
     // Derived classes can initialize specific style here
+
+    connect(this,
+            &NodeDelegateModel::portsDeleted,
+            this,
+            &NodeDelegateModel::invalidateDataTypeHandles);
+
+    connect(this,
+            &NodeDelegateModel::portsInserted,
+            this,
+            &NodeDelegateModel::invalidateDataTypeHandles);
+
+    // Port types may depend on the node's state.
+    connect(this,
+            &NodeDelegateModel::dataUpdated,
+            this,
+            &NodeDelegateModel::invalidateDataTypeHandles);
+
+    connect(this,
+            &NodeDelegateModel::embeddedWidgetSizeUpdated,
+            this,
+            &NodeDelegateModel::invalidateDataTypeHandles);
 }
 
 QJsonObject NodeDelegateModel::save() const
@@ -41,6 +65,52 @@ ConnectionPolicy NodeDelegateModel::portConnectionPolicy(PortType portType, Port
     return result;
 }
 
+void NodeDelegateModel::setInDataBatch(
+    std::vector<std::pair<PortIndex, std::shared_ptr<NodeData>>> const &inputs)
+{
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+        _moreInDataPending = (i + 1 < inputs.size());
+
+        setInData(inputs[i].second, inputs[i].first);
+    }
+
+    _moreInDataPending = false;
+}
+
+std::vector<std::shared_ptr<NodeData>> NodeDelegateModel::compute(
+    std::vector<std::shared_ptr<NodeData>> const &) const
+{
+    return {};
+}
+
+void NodeDelegateModel::setComputedData(std::vector<std::shared_ptr<NodeData>> const &,
+                                        std::vector<std::shared_ptr<NodeData>> const &)
+{
+    //
+}
+
+DataTypeHandle NodeDelegateModel::dataTypeHandle(PortType portType, PortIndex portIndex) const
+{
+    auto &handles = (portType == PortType::In) ? _inTypeHandles : _outTypeHandles;
+
+    if (portIndex >= handles.size())
+        handles.resize(std::max<std::size_t>(portIndex + 1, nPorts(portType)),
+                       InvalidDataTypeHandle);
+
+    DataTypeHandle &handle = handles[portIndex];
+
+    if (handle == InvalidDataTypeHandle)
+        handle = DataTypeRegistry::instance().intern(dataType(portType, portIndex).id);
+
+    return handle;
+}
+
+void NodeDelegateModel::invalidateDataTypeHandles()
+{
+    _inTypeHandles.clear();
+    _outTypeHandles.clear();
+}
+
 NodeStyle const &NodeDelegateModel::nodeStyle() const
 {
     return _nodeStyle;
@@ -3,7 +3,6 @@
 #include <cstdlib>
 #include <iostream>
 
-#include <QtWidgets/QGraphicsEffect>
 #include <QtWidgets/QtWidgets>
 
 #include "AbstractGraphModel.hpp"
@@ -18,8 +17,13 @@
 
 namespace QtNodes {
 
+namespace {
+quint64 nodeInsertionCounter = 0;
+}
+
 NodeGraphicsObject::NodeGraphicsObject(BasicGraphicsScene &scene, NodeId nodeId)
     : _nodeId(nodeId)
+    , _insertionOrder(++nodeInsertionCounter)
     , _graphModel(scene.graphModel())
     , _nodeState(*this)
     , _proxyWidget(nullptr)
@@ -33,18 +37,9 @@ NodeGraphicsObject::NodeGraphicsObject(BasicGraphicsScene &scene, NodeId nodeId)
 
     setCacheMode(QGraphicsItem::DeviceCoordinateCache);
 
-    QJsonObject nodeStyleJson = _graphModel.nodeData(_nodeId, NodeRole::Style).toJsonObject();
-
-    NodeStyle nodeStyle(nodeStyleJson);
-
-    {
-        auto effect = new QGraphicsDropShadowEffect;
-        effect->setOffset(4, 4);
-        effect->setBlurRadius(20);
-        effect->setColor(nodeStyle.ShadowColor);
-
-        setGraphicsEffect(effect);
-    }
+    // No QGraphicsEffect for the shadow, the node painter draws it from a
+    // shared pixmap instead of blurring every node offscreen.
+    NodeStyle const &nodeStyle = _graphModel.nodeStyle(_nodeId);
 
     setOpacity(nodeStyle.Opacity);
 
@@ -60,12 +55,24 @@ NodeGraphicsObject::NodeGraphicsObject(BasicGraphicsScene &scene, NodeId nodeId)
 
     setPos(pos);
 
+    nodeScene()->updateSpatialIndex(*this);
+
+    updateLevelOfDetail();
+
+    nodeScene()->updateWidgetEmbedding(*this);
+
     connect(&_graphModel, &AbstractGraphModel::nodeFlagsUpdated, [this](NodeId const nodeId) {
         if (_nodeId == nodeId)
             setLockedState();
     });
 }
 
+NodeGraphicsObject::~NodeGraphicsObject()
+{
+    // An embedded widget is deleted by its proxy, a detached one the same way.
+    delete _detachedWidget.data();
+}
+
 AbstractGraphModel &NodeGraphicsObject::graphModel() const
 {
     return _graphModel;
@@ -84,16 +91,30 @@ void NodeGraphicsObject::updateQWidgetEmbedPos()
   }
 }
 
+void NodeGraphicsObject::updateLevelOfDetail()
+{
+    if (_proxyWidget)
+        _proxyWidget->setVisible(nodeScene()->levelOfDetail() == LevelOfDetail::Full);
+}
+
 void NodeGraphicsObject::embedQWidget()
 {
     AbstractNodeGeometry &geometry = nodeScene()->nodeGeometry();
     geometry.recomputeSize(_nodeId);
 
-    if (auto w = _graphModel.nodeData(_nodeId, NodeRole::Widget).value<QWidget *>()) {
+    if (auto w = _graphModel.nodeWidget(_nodeId)) {
         _proxyWidget = new QGraphicsProxyWidget(this);
 
         _proxyWidget->setWidget(w);
 
+        // Hidden when it was taken out of the previous proxy.
+        if (w == _detachedWidget) {
+            w->show();
+            _detachedWidget = nullptr;
+        }
+
+        _widgetSnapshot = QPixmap();
+
         _proxyWidget->setPreferredWidth(5);
 
         geometry.recomputeSize(_nodeId);
@@ -116,6 +137,41 @@ void NodeGraphicsObject::embedQWidget()
     }
 }
 
+void NodeGraphicsObject::setWidgetEmbedded(bool embedded)
+{
+    if (embedded == widgetEmbedded())
+        return;
+
+    if (embedded) {
+        if (!_graphModel.nodeWidget(_nodeId))
+            return;
+
+        // Embedding recomputes the node size.
+        prepareGeometryChange();
+
+        embedQWidget();
+        updateLevelOfDetail();
+    } else {
+        QWidget *w = _proxyWidget->widget();
+
+        if (w) {
+            _widgetSnapshot = w->grab();
+
+            // Keeps the widget from popping up as a top-level window.
+            w->hide();
+
+            _proxyWidget->setWidget(nullptr);
+        }
+
+        delete _proxyWidget;
+        _proxyWidget = nullptr;
+
+        _detachedWidget = w;
+    }
+
+    update();
+}
+
 void NodeGraphicsObject::setLockedState()
 {
     NodeFlags flags = _graphModel.nodeFlags(_nodeId);
@@ -163,12 +219,25 @@ void NodeGraphicsObject::paint(QPainter *painter, QStyleOptionGraphicsItem const
     painter->setClipRect(option->exposedRect);
 
     nodeScene()->nodePainter().paint(painter, *this);
+
+    // Stands in for the detached widget.
+    if (!_proxyWidget && !_widgetSnapshot.isNull()
+        && nodeScene()->levelOfDetail() != LevelOfDetail::Minimal) {
+        AbstractNodeGeometry &geometry = nodeScene()->nodeGeometry();
+
+        painter->drawPixmap(geometry.widgetPosition(_nodeId), _widgetSnapshot);
+    }
 }
 
 QVariant NodeGraphicsObject::itemChange(GraphicsItemChange change, const QVariant &value)
 {
     if (change == ItemScenePositionHasChanged && scene()) {
-        moveConnections();
+        nodeScene()->updateSpatialIndex(*this);
+        nodeScene()->updateWidgetEmbedding(*this);
+
+        // During a drag the scene updates the connections of all the moved nodes at once.
+        if (!nodeScene()->nodeDragActive())
+            moveConnections();
     }
 
     return QGraphicsObject::itemChange(change, value);
@@ -256,7 +325,7 @@ void NodeGraphicsObject::mouseMoveEvent(QGraphicsSceneMouseEvent *event)
     if (_nodeState.resizing()) {
         auto diff = event->pos() - event->lastPos();
 
-        if (auto w = _graphModel.nodeData<QWidget *>(_nodeId, NodeRole::Widget)) {
+        if (auto w = _graphModel.nodeWidget(_nodeId)) {
             prepareGeometryChange();
 
             auto oldSize = w->size();
@@ -277,9 +346,10 @@ void NodeGraphicsObject::mouseMoveEvent(QGraphicsSceneMouseEvent *event)
             event->accept();
         }
     } else {
-        auto diff = event->pos() - event->lastPos();
+        if (!nodeScene()->nodeDragActive())
+            nodeScene()->beginNodeDrag();
 
-        nodeScene()->undoStack().push(new MoveNodeCommand(nodeScene(), diff));
+        nodeScene()->dragNodes(event->scenePos() - event->lastScenePos());
 
         event->accept();
     }
@@ -295,6 +365,8 @@ void NodeGraphicsObject::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
 {
     _nodeState.setResizing(false);
 
+    nodeScene()->endNodeDrag();
+
     QGraphicsObject::mouseReleaseEvent(event);
 
     // position connections precisely after fast node move
@@ -306,11 +378,9 @@ void NodeGraphicsObject::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
 void NodeGraphicsObject::hoverEnterEvent(QGraphicsSceneHoverEvent *event)
 {
     // bring all the colliding nodes to background
-    QList<QGraphicsItem *> overlapItems = collidingItems();
-
-    for (QGraphicsItem *item : overlapItems) {
-        if (item->zValue() > 0.0) {
-            item->setZValue(0.0);
+    for (NodeGraphicsObject *ngo : nodeScene()->nodesIn(sceneBoundingRect())) {
+        if (ngo != this && ngo->zValue() > 0.0) {
+            ngo->setZValue(0.0);
         }
     }
 
@@ -2,6 +2,7 @@
 
 #include "BasicGraphicsScene.hpp"
 #include "ConnectionGraphicsObject.hpp"
+#include "ConnectionIdHash.hpp"
 #include "ConnectionIdUtils.hpp"
 #include "Definitions.hpp"
 #include "NodeGraphicsObject.hpp"
@@ -14,20 +15,58 @@
 #include <QtWidgets/QGraphicsObject>
 
 #include <typeinfo>
+#include <unordered_map>
+#include <utility>
 
 namespace QtNodes {
 
-static QJsonObject serializeSelectedItems(BasicGraphicsScene *scene)
+void GraphDiff::updateMemoryCost()
 {
-    QJsonObject serializedScene;
+    _memoryCost = sizeof(GraphDiff) + nodes.capacity() * sizeof(Node)
+                  + connections.capacity() * sizeof(ConnectionId);
 
+    for (Node const &node : nodes) {
+        _memoryCost += node.state.size();
+    }
+}
+
+void GraphDiff::clear()
+{
+    // Swapping releases the memory, `clear()` alone keeps the capacity.
+    std::vector<Node>().swap(nodes);
+    std::vector<ConnectionId>().swap(connections);
+
+    _memoryCost = 0;
+}
+
+void DiffCommand::expire()
+{
+    _diff.clear();
+
+    setObsolete(true);
+}
+
+//-------------------------------------
+
+static void addNodeToDiff(GraphDiff &diff, AbstractGraphModel const &graphModel, NodeId const nodeId)
+{
+    diff.nodes.push_back({nodeId,
+                          graphModel.nodeData(nodeId, NodeRole::Position).value<QPointF>(),
+                          graphModel.saveNodeState(nodeId)});
+}
+
+/// The clipboard keeps the JSON format, so it can be pasted into other applications.
+static QJsonObject sceneJsonFromSelectedItems(BasicGraphicsScene *scene)
+{
     auto &graphModel = scene->graphModel();
 
+    QList<QGraphicsItem *> const selectedItems = scene->selectedItems();
+
     std::unordered_set<NodeId> selectedNodes;
 
     QJsonArray nodesJsonArray;
 
-    for (QGraphicsItem *item : scene->selectedItems()) {
+    for (QGraphicsItem *item : selectedItems) {
         if (auto n = qgraphicsitem_cast<NodeGraphicsObject *>(item)) {
             nodesJsonArray.append(graphModel.saveNode(n->nodeId()));
 
@@ -37,7 +76,7 @@ static QJsonObject serializeSelectedItems(BasicGraphicsScene *scene)
 
     QJsonArray connJsonArray;
 
-    for (QGraphicsItem *item : scene->selectedItems()) {
+    for (QGraphicsItem *item : selectedItems) {
         if (auto c = qgraphicsitem_cast<ConnectionGraphicsObject *>(item)) {
             auto const &cid = c->connectionId();
 
@@ -47,76 +86,118 @@ static QJsonObject serializeSelectedItems(BasicGraphicsScene *scene)
         }
     }
 
-    serializedScene["nodes"] = nodesJsonArray;
-    serializedScene["connections"] = connJsonArray;
+    QJsonObject sceneJson;
+
+    sceneJson["nodes"] = nodesJsonArray;
+    sceneJson["connections"] = connJsonArray;
 
-    return serializedScene;
+    return sceneJson;
 }
 
-static void insertSerializedItems(QJsonObject const &json, BasicGraphicsScene *scene)
+/// Takes the ids and positions only, the node states are captured on the first undo.
+static GraphDiff diffFromJson(QJsonObject const &sceneJson)
 {
-    AbstractGraphModel &graphModel = scene->graphModel();
+    GraphDiff diff;
 
-    QJsonArray const &nodesJsonArray = json["nodes"].toArray();
+    QJsonArray const nodesJsonArray = sceneJson["nodes"].toArray();
 
-    for (QJsonValue node : nodesJsonArray) {
-        QJsonObject obj = node.toObject();
+    diff.nodes.reserve(nodesJsonArray.size());
 
-        graphModel.loadNode(obj);
+    for (QJsonValue const node : nodesJsonArray) {
+        QJsonObject const nodeJson = node.toObject();
+        QJsonObject const posJson = nodeJson["position"].toObject();
 
-        auto id = obj["id"].toInt();
-        scene->nodeGraphicsObject(id)->setZValue(1.0);
-        scene->nodeGraphicsObject(id)->setSelected(true);
+        diff.nodes.push_back({static_cast<NodeId>(nodeJson["id"].toInt()),
+                              QPointF(posJson["x"].toDouble(), posJson["y"].toDouble()),
+                              QByteArray()});
     }
 
-    QJsonArray const &connJsonArray = json["connections"].toArray();
+    QJsonArray const connJsonArray = sceneJson["connections"].toArray();
 
-    for (QJsonValue connection : connJsonArray) {
-        QJsonObject connJson = connection.toObject();
+    diff.connections.reserve(connJsonArray.size());
 
-        ConnectionId connId = fromJson(connJson);
-
-        // Restore the connection
-        graphModel.addConnection(connId);
-
-        scene->connectionGraphicsObject(connId)->setSelected(true);
+    for (QJsonValue const connection : connJsonArray) {
+        diff.connections.push_back(fromJson(connection.toObject()));
     }
+
+    return diff;
 }
 
-static void deleteSerializedItems(QJsonObject &sceneJson, AbstractGraphModel &graphModel)
+/**
+ * Restores the nodes from their compact states, or from `nodesJson` when
+ * given, which holds one node object per entry of `diff.nodes`.
+ */
+static void insertDiff(GraphDiff const &diff,
+                       BasicGraphicsScene *scene,
+                       QJsonArray const &nodesJson = QJsonArray())
 {
-    QJsonArray connectionJsonArray = sceneJson["connections"].toArray();
+    AbstractGraphModel &graphModel = scene->graphModel();
 
-    for (QJsonValueRef connection : connectionJsonArray) {
-        QJsonObject connJson = connection.toObject();
+    {
+        // The graphics objects are created when the batch ends.
+        ScopedGraphBatch batch(graphModel);
 
-        ConnectionId connId = fromJson(connJson);
+        for (std::size_t i = 0; i < diff.nodes.size(); ++i) {
+            GraphDiff::Node const &node = diff.nodes[i];
 
-        graphModel.deleteConnection(connId);
+            if (nodesJson.isEmpty()) {
+                graphModel.loadNodeState(node.id, node.position, node.state);
+                continue;
+            }
+
+            QJsonObject nodeJson = nodesJson[static_cast<int>(i)].toObject();
+
+            nodeJson["id"] = static_cast<qint64>(node.id);
+
+            QJsonObject posJson;
+            posJson["x"] = node.position.x();
+            posJson["y"] = node.position.y();
+            nodeJson["position"] = posJson;
+
+            graphModel.loadNode(nodeJson);
+        }
+
+        for (ConnectionId const &connId : diff.connections) {
+            // Restore the connection
+            graphModel.addConnection(connId);
+        }
     }
 
-    QJsonArray nodesJsonArray = sceneJson["nodes"].toArray();
+    for (GraphDiff::Node const &node : diff.nodes) {
+        if (auto ngo = scene->nodeGraphicsObject(node.id)) {
+            ngo->setZValue(1.0);
+            ngo->setSelected(true);
+        }
+    }
 
-    for (QJsonValueRef node : nodesJsonArray) {
-        QJsonObject nodeJson = node.toObject();
-        graphModel.deleteNode(nodeJson["id"].toInt());
+    for (ConnectionId const &connId : diff.connections) {
+        if (auto cgo = scene->connectionGraphicsObject(connId))
+            cgo->setSelected(true);
     }
 }
 
-static QPointF computeAverageNodePosition(QJsonObject const &sceneJson)
+static void deleteDiff(GraphDiff const &diff, AbstractGraphModel &graphModel)
 {
-    QPointF averagePos(0, 0);
+    ScopedGraphBatch batch(graphModel);
+
+    for (ConnectionId const &connId : diff.connections) {
+        graphModel.deleteConnection(connId);
+    }
 
-    QJsonArray nodesJsonArray = sceneJson["nodes"].toArray();
+    for (GraphDiff::Node const &node : diff.nodes) {
+        graphModel.deleteNode(node.id);
+    }
+}
 
-    for (QJsonValueRef node : nodesJsonArray) {
-        QJsonObject nodeJson = node.toObject();
+static QPointF computeAverageNodePosition(GraphDiff const &diff)
+{
+    QPointF averagePos(0, 0);
 
-        averagePos += QPointF(nodeJson["position"].toObject()["x"].toDouble(),
-                              nodeJson["position"].toObject()["y"].toDouble());
+    for (GraphDiff::Node const &node : diff.nodes) {
+        averagePos += node.position;
     }
 
-    averagePos /= static_cast<double>(nodesJsonArray.size());
+    averagePos /= static_cast<double>(diff.nodes.size());
 
     return averagePos;
 }
@@ -127,7 +208,6 @@ CreateCommand::CreateCommand(BasicGraphicsScene *scene,
                              QString const name,
                              QPointF const &mouseScenePos)
     : _scene(scene)
-    , _sceneJson(QJsonObject())
 {
     _nodeId = _scene->graphModel().addNode(name);
     if (_nodeId != InvalidNodeId) {
@@ -139,19 +219,19 @@ CreateCommand::CreateCommand(BasicGraphicsScene *scene,
 
 void CreateCommand::undo()
 {
-    QJsonArray nodesJsonArray;
-    nodesJsonArray.append(_scene->graphModel().saveNode(_nodeId));
-    _sceneJson["nodes"] = nodesJsonArray;
+    _diff.clear();
+    addNodeToDiff(_diff, _scene->graphModel(), _nodeId);
+    _diff.updateMemoryCost();
 
     _scene->graphModel().deleteNode(_nodeId);
 }
 
 void CreateCommand::redo()
 {
-    if (_sceneJson.empty() || _sceneJson["nodes"].toArray().empty())
+    if (_diff.nodes.empty())
         return;
 
-    insertSerializedItems(_sceneJson, _scene);
+    insertDiff(_diff, _scene);
 }
 
 //-------------------------------------
@@ -161,83 +241,59 @@ DeleteCommand::DeleteCommand(BasicGraphicsScene *scene)
 {
     auto &graphModel = _scene->graphModel();
 
-    QJsonArray connJsonArray;
+    QList<QGraphicsItem *> const selectedItems = _scene->selectedItems();
+
+    // A connection may be selected and attached to a selected node at the
+    // same time, or attached to two of them.
+    std::unordered_set<ConnectionId> connections;
+
     // Delete the selected connections first, ensuring that they won't be
     // automatically deleted when selected nodes are deleted (deleting a
     // node deletes some connections as well)
-    for (QGraphicsItem *item : _scene->selectedItems()) {
+    for (QGraphicsItem *item : selectedItems) {
         if (auto c = qgraphicsitem_cast<ConnectionGraphicsObject *>(item)) {
-            auto const &cid = c->connectionId();
-
-            connJsonArray.append(toJson(cid));
+            connections.insert(c->connectionId());
         }
     }
 
-    QJsonArray nodesJsonArray;
     // Delete the nodes; this will delete many of the connections.
     // Selected connections were already deleted prior to this loop,
-    for (QGraphicsItem *item : _scene->selectedItems()) {
+    for (QGraphicsItem *item : selectedItems) {
         if (auto n = qgraphicsitem_cast<NodeGraphicsObject *>(item)) {
             // saving connections attached to the selected nodes
             for (auto const &cid : graphModel.allConnectionIds(n->nodeId())) {
-                connJsonArray.append(toJson(cid));
+                connections.insert(cid);
             }
 
-            nodesJsonArray.append(graphModel.saveNode(n->nodeId()));
+            addNodeToDiff(_diff, graphModel, n->nodeId());
         }
     }
 
+    _diff.connections.assign(connections.begin(), connections.end());
+    _diff.updateMemoryCost();
+
     // If nothing is deleted, cancel this operation
-    if (connJsonArray.isEmpty() && nodesJsonArray.isEmpty())
+    if (_diff.empty())
         setObsolete(true);
-
-    _sceneJson["nodes"] = nodesJsonArray;
-    _sceneJson["connections"] = connJsonArray;
 }
 
 void DeleteCommand::undo()
 {
-    insertSerializedItems(_sceneJson, _scene);
+    insertDiff(_diff, _scene);
 }
 
 void DeleteCommand::redo()
 {
-    deleteSerializedItems(_sceneJson, _scene->graphModel());
-}
-
-//-------------------------------------
-
-void offsetNodeGroup(QJsonObject &sceneJson, QPointF const &diff)
-{
-    QJsonArray nodesJsonArray = sceneJson["nodes"].toArray();
-
-    QJsonArray newNodesJsonArray;
-    for (QJsonValueRef node : nodesJsonArray) {
-        QJsonObject obj = node.toObject();
-
-        QPointF oldPos(obj["position"].toObject()["x"].toDouble(),
-                       obj["position"].toObject()["y"].toDouble());
-
-        oldPos += diff;
-
-        QJsonObject posJson;
-        posJson["x"] = oldPos.x();
-        posJson["y"] = oldPos.y();
-        obj["position"] = posJson;
-
-        newNodesJsonArray.append(obj);
-    }
-
-    sceneJson["nodes"] = newNodesJsonArray;
+    deleteDiff(_diff, _scene->graphModel());
 }
 
 //-------------------------------------
 
 CopyCommand::CopyCommand(BasicGraphicsScene *scene)
 {
-    QJsonObject sceneJson = serializeSelectedItems(scene);
+    QJsonObject const sceneJson = sceneJsonFromSelectedItems(scene);
 
-    if (sceneJson.empty() || sceneJson["nodes"].toArray().empty()) {
+    if (sceneJson["nodes"].toArray().isEmpty()) {
         setObsolete(true);
         return;
     }
@@ -262,25 +318,44 @@ CopyCommand::CopyCommand(BasicGraphicsScene *scene)
 
 PasteCommand::PasteCommand(BasicGraphicsScene *scene, QPointF const &mouseScenePos)
     : _scene(scene)
-    , _mouseScenePos(mouseScenePos)
 {
-    _newSceneJson = takeSceneJsonFromClipboard();
+    QJsonObject const sceneJson = takeSceneJsonFromClipboard();
 
-    if (_newSceneJson.empty() || _newSceneJson["nodes"].toArray().empty()) {
+    _diff = diffFromJson(sceneJson);
+
+    if (_diff.nodes.empty()) {
         setObsolete(true);
         return;
     }
 
-    _newSceneJson = makeNewNodeIdsInScene(_newSceneJson);
+    makeNewNodeIdsInScene();
 
-    QPointF averagePos = computeAverageNodePosition(_newSceneJson);
+    QPointF const offset = mouseScenePos - computeAverageNodePosition(_diff);
 
-    offsetNodeGroup(_newSceneJson, _mouseScenePos - averagePos);
+    for (GraphDiff::Node &node : _diff.nodes) {
+        node.position += offset;
+    }
+
+    _pastedNodes = sceneJson["nodes"].toArray();
+
+    _diff.updateMemoryCost();
 }
 
 void PasteCommand::undo()
 {
-    deleteSerializedItems(_newSceneJson, _scene->graphModel());
+    auto &graphModel = _scene->graphModel();
+
+    if (!_pastedNodes.isEmpty()) {
+        for (GraphDiff::Node &node : _diff.nodes) {
+            node.state = graphModel.saveNodeState(node.id);
+        }
+
+        _pastedNodes = QJsonArray();
+
+        _diff.updateMemoryCost();
+    }
+
+    deleteDiff(_diff, graphModel);
 }
 
 void PasteCommand::redo()
@@ -289,17 +364,17 @@ void PasteCommand::redo()
 
     // Ignore if pasted in content does not generate nodes.
     try {
-        insertSerializedItems(_newSceneJson, _scene);
+        insertDiff(_diff, _scene, _pastedNodes);
     } catch (...) {
-        // If the paste does not work, delete all selected nodes and connections
+        // If the paste does not work, delete the nodes inserted so far
         // `deleteNode(...)` implicitly removed connections
         auto &graphModel = _scene->graphModel();
 
-        QJsonArray nodesJsonArray;
-        for (QGraphicsItem *item : _scene->selectedItems()) {
-            if (auto n = qgraphicsitem_cast<NodeGraphicsObject *>(item)) {
-                graphModel.deleteNode(n->nodeId());
-            }
+        ScopedGraphBatch batch(graphModel);
+
+        for (GraphDiff::Node const &node : _diff.nodes) {
+            if (graphModel.nodeExists(node.id))
+                graphModel.deleteNode(node.id);
         }
 
         setObsolete(true);
@@ -321,52 +396,24 @@ QJsonObject PasteCommand::takeSceneJsonFromClipboard()
     return json.object();
 }
 
-QJsonObject PasteCommand::makeNewNodeIdsInScene(QJsonObject const &sceneJson)
+void PasteCommand::makeNewNodeIdsInScene()
 {
     AbstractGraphModel &graphModel = _scene->graphModel();
 
     std::unordered_map<NodeId, NodeId> mapNodeIds;
 
-    QJsonArray nodesJsonArray = sceneJson["nodes"].toArray();
-
-    QJsonArray newNodesJsonArray;
-    for (QJsonValueRef node : nodesJsonArray) {
-        QJsonObject nodeJson = node.toObject();
-
-        NodeId oldNodeId = nodeJson["id"].toInt();
+    for (GraphDiff::Node &node : _diff.nodes) {
+        NodeId const newNodeId = graphModel.newNodeId();
 
-        NodeId newNodeId = graphModel.newNodeId();
+        mapNodeIds[node.id] = newNodeId;
 
-        mapNodeIds[oldNodeId] = newNodeId;
-
-        // Replace NodeId in json
-        nodeJson["id"] = static_cast<qint64>(newNodeId);
-
-        newNodesJsonArray.append(nodeJson);
+        node.id = newNodeId;
     }
 
-    QJsonArray connectionJsonArray = sceneJson["connections"].toArray();
-
-    QJsonArray newConnJsonArray;
-    for (QJsonValueRef connection : connectionJsonArray) {
-        QJsonObject connJson = connection.toObject();
-
-        ConnectionId connId = fromJson(connJson);
-
-        ConnectionId newConnId{mapNodeIds[connId.outNodeId],
-                               connId.outPortIndex,
-                               mapNodeIds[connId.inNodeId],
-                               connId.inPortIndex};
-
-        newConnJsonArray.append(toJson(newConnId));
+    for (ConnectionId &connId : _diff.connections) {
+        connId.outNodeId = mapNodeIds[connId.outNodeId];
+        connId.inNodeId = mapNodeIds[connId.inNodeId];
     }
-
-    QJsonObject newSceneJson;
-
-    newSceneJson["nodes"] = newNodesJsonArray;
-    newSceneJson["connections"] = newConnJsonArray;
-
-    return newSceneJson;
 }
 
 //-------------------------------------
@@ -421,8 +468,20 @@ MoveNodeCommand::MoveNodeCommand(BasicGraphicsScene *scene, QPointF const &diff)
     }
 }
 
+MoveNodeCommand::MoveNodeCommand(BasicGraphicsScene *scene,
+                                 std::unordered_set<NodeId> nodes,
+                                 QPointF const &diff)
+    : _scene(scene)
+    , _selectedNodes(std::move(nodes))
+    , _diff(diff)
+{
+    //
+}
+
 void MoveNodeCommand::undo()
 {
+    ScopedGraphBatch batch(_scene->graphModel());
+
     for (auto nodeId : _selectedNodes) {
         auto oldPos = _scene->graphModel().nodeData(nodeId, NodeRole::Position).value<QPointF>();
 
@@ -434,6 +493,8 @@ void MoveNodeCommand::undo()
 
 void MoveNodeCommand::redo()
 {
+    ScopedGraphBatch batch(_scene->graphModel());
+
     for (auto nodeId : _selectedNodes) {
         auto oldPos = _scene->graphModel().nodeData(nodeId, NodeRole::Position).value<QPointF>();
 
@@ -445,18 +506,7 @@ void MoveNodeCommand::redo()
 
 int MoveNodeCommand::id() const
 {
-    return static_cast<int>(typeid(MoveNodeCommand).hash_code());
-}
-
-bool MoveNodeCommand::mergeWith(QUndoCommand const *c)
-{
-    auto mc = static_cast<MoveNodeCommand const *>(c);
-
-    if (_selectedNodes == mc->_selectedNodes) {
-        _diff += mc->_diff;
-        return true;
-    }
-    return false;
+    return -1;
 }
 
 } // namespace QtNodes